@@ -10,6 +10,8 @@
 #    if LOG_TIMESTAMP_FORMAT > 0U
 #        include <time.h>
 #    endif
+#    include <string.h>
+#    include <stdatomic.h>
 
 /* -------------------------------------------------------------------------- */
 
@@ -21,39 +23,723 @@
 
 /* -------------------------------------------------------------------------- */
 
+#    if (LOG_DEFERRED_FORMAT == 1U) || (LOG_DEFERRED_DECODER == 1U)
+/* Frame is header byte, varint payload length and payload */
+#        define _FRAME_MAGIC       (0xA0U)
+#        define _FRAME_TEXT        (0x01U)
+#        define _FRAME_MESSAGE     (0x02U)
+#        define _FRAME_MAX_PAYLOAD (_LINE_LENGTH)
+#        define _VARINT_MAX        (10U)
+
+#        if LOG_MAX_MESSAGE_LENGTH > 16000U
+#            error Deferred frame length is limited by 2 bytes varint, decrease LOG_MAX_MESSAGE_LENGTH
+#        endif
+#    endif  // (LOG_DEFERRED_FORMAT == 1U) || (LOG_DEFERRED_DECODER == 1U)
+
+#    if (LOG_DEFERRED_FORMAT == 1U) || (LOG_DEFERRED_DECODER == 1U) || (LOG_BUILTIN_PRINTF == 1U)
+#        define _SPEC_PARSER (1U)
+#    else
+#        define _SPEC_PARSER (0U)
+#    endif
+
+#    if _SPEC_PARSER == 1U
+typedef enum {
+    _LENGTH_NONE,
+    _LENGTH_HH,
+    _LENGTH_H,
+    _LENGTH_L,
+    _LENGTH_LL,
+    _LENGTH_J,
+    _LENGTH_Z,
+    _LENGTH_T,
+    _LENGTH_LONG_DOUBLE,
+} _length_t;
+
+typedef struct {
+    char conversion;
+    _length_t length;
+    bool width_arg;
+    bool precision_arg;
+    int precision;
+    uint32_t width;
+    bool is_left;
+    bool is_zero;
+    bool is_plus;
+    bool is_space;
+    bool is_alternate;
+} _format_spec_t;
+#    endif  // _SPEC_PARSER == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_TIMESTAMP_TICKS == 1U
+#        if (LOG_TIMESTAMP_TICK_HZ < 1U) || (LOG_TIMESTAMP_TICK_HZ > 0xFFFFFFFFUL)
+#            error LOG_TIMESTAMP_TICK_HZ must fit 32 bits
+#        endif
+/* 32 bits of microseconds wrap in 71 minutes, of cycle counter at 168 MHz in 25 seconds */
+#        if LOG_TIMESTAMP_64BIT == 0U
+#            error LOG_TIMESTAMP_TICKS needs LOG_TIMESTAMP_64BIT, io->get_ticks must not wrap
+#        endif
+/* Ticks per second and digits of fraction of timestamp */
+#        define _STAMP_HZ     (LOG_TIMESTAMP_TICK_HZ)
+#        define _STAMP_DIGITS (6U)
+#    else
+#        define _STAMP_HZ     (1000U)
+#        define _STAMP_DIGITS (3U)
+#    endif  // LOG_TIMESTAMP_TICKS == 1U
+
+#    if (LOG_TIMESTAMP_DELTA == 1U) && (LOG_TIMESTAMP_ENABLED == 1U)
+#        if (LOG_ASYNC_ENABLED == 1U) || (LOG_PARALLEL_FORMAT == 1U) || (LOG_ISR_QUEUE == 1U)
+#            error Delta timestamps need lines to be formatted in order, disable LOG_ASYNC_ENABLED, LOG_PARALLEL_FORMAT and LOG_ISR_QUEUE
+#        endif
+#        if (LOG_TIMESTAMP_RESYNC_LINES < 1U) || (LOG_TIMESTAMP_RESYNC_S < 1U) || (LOG_TIMESTAMP_RESYNC_S > 4000U)
+#            error LOG_TIMESTAMP_RESYNC_LINES must be at least 1, LOG_TIMESTAMP_RESYNC_S from 1 to 4000
+#        endif
+#    endif  // (LOG_TIMESTAMP_DELTA == 1U) && (LOG_TIMESTAMP_ENABLED == 1U)
+
+#    if (LOG_COLLAPSE_REPEATS == 1U) && (LOG_ASYNC_ENABLED == 1U)
+#        error LOG_COLLAPSE_REPEATS needs lines to be written in order, disable LOG_ASYNC_ENABLED
+#    endif
+
+#    if LOG_ASYNC_ENABLED == 1U
+#        if (LOG_ASYNC_BUFFER_SIZE < 64U) || ((LOG_ASYNC_BUFFER_SIZE & (LOG_ASYNC_BUFFER_SIZE - 1U)) != 0U)
+#            error LOG_ASYNC_BUFFER_SIZE must be power of two
+#        endif
+#        if LOG_ISR_QUEUE == 1U
+#            error Ring buffer of LOG_ASYNC_ENABLED is interrupt safe, disable LOG_ISR_QUEUE
+#        endif
+#        define _RING_WORDS (LOG_ASYNC_BUFFER_SIZE / sizeof(uint32_t))
+#    elif LOG_ISR_QUEUE == 1U
+#        if (LOG_ISR_QUEUE_SIZE < 64U) || ((LOG_ISR_QUEUE_SIZE & (LOG_ISR_QUEUE_SIZE - 1U)) != 0U)
+#            error LOG_ISR_QUEUE_SIZE must be power of two
+#        endif
+#        if LOG_ISR_FLUSH_BUDGET == 0U
+#            error LOG_ISR_FLUSH_BUDGET must be at least one message
+#        endif
+/* Only interrupts put messages to the ring, others are written directly */
+#        define _RING_WORDS (LOG_ISR_QUEUE_SIZE / sizeof(uint32_t))
+#    endif  // LOG_ASYNC_ENABLED == 1U
+
+#    if LOG_SINKS_ENABLED == 1U
+#        if LOG_DEFERRED_FORMAT == 1U
+#            error Sinks take parts of text lines, disable LOG_DEFERRED_FORMAT
+#        endif
+#        if LOG_SINK_QUEUE_SIZE > 0U
+#            if (LOG_SINK_QUEUE_SIZE < 64U) || ((LOG_SINK_QUEUE_SIZE & (LOG_SINK_QUEUE_SIZE - 1U)) != 0U)
+#                error LOG_SINK_QUEUE_SIZE must be power of two
+#            endif
+#            define _SINK_QUEUE_ENABLED (1U)
+#        else
+#            define _SINK_QUEUE_ENABLED (0U)
+#        endif  // LOG_SINK_QUEUE_SIZE > 0U
+#    else
+#        define _SINK_QUEUE_ENABLED (0U)
+#    endif  // LOG_SINKS_ENABLED == 1U
+
+#    if LOG_RECORDER_ENABLED == 1U
+#        if LOG_DEFERRED_FORMAT == 1U
+#            error Flight recorder keeps text lines, disable LOG_DEFERRED_FORMAT
+#        endif
+#        if (LOG_RECORDER_SIZE < 256U) || ((LOG_RECORDER_SIZE & (LOG_RECORDER_SIZE - 1U)) != 0U)
+#            error LOG_RECORDER_SIZE must be power of two, at least 256 bytes
+#        endif
+/*
+    Record is header word, checksum word and payload padded to the word, header has length and tag of its position,
+    checksum is FNV-1a hash of payload seeded by the header
+*/
+#        define _RECORDER_MAGIC    (0x4C4F4753UL)
+#        define _RECORDER_OVERHEAD (2U * sizeof(uint32_t))
+#        define _RECORDER_MAX_LINE \
+            (((_LINE_LENGTH + _RECORDER_OVERHEAD) < LOG_RECORDER_SIZE) ? _LINE_LENGTH : (LOG_RECORDER_SIZE - _RECORDER_OVERHEAD))
+
+typedef struct {
+    uint32_t magic;
+    uint32_t size;
+    /* Positions in bytes, they wrap around, records between tail and head are valid */
+    uint32_t head;
+    uint32_t tail;
+    uint8_t data[LOG_RECORDER_SIZE];
+} log_recorder_t;
+#    endif  // LOG_RECORDER_ENABLED == 1U
+
+#    if LOG_PARALLEL_FORMAT == 1U
+#        if LOG_COLLAPSE_REPEATS == 1U
+#            error LOG_COLLAPSE_REPEATS compares lines in the shared buffer, disable LOG_PARALLEL_FORMAT
+#        endif
+#        if (LOG_IO_ATOMIC == 1U) && ((LOG_COMPRESS_ENABLED == 1U) || (LOG_RECORDER_ENABLED == 1U))
+#            error Compression and flight recorder keep state between lines, disable LOG_IO_ATOMIC
+#        endif
+#    endif  // LOG_PARALLEL_FORMAT == 1U
+
+#    if LOG_IO_RESERVE == 1U
+#        if (LOG_ASYNC_ENABLED == 1U) || (LOG_PARALLEL_FORMAT == 1U)
+#            error LOG_IO_RESERVE needs line formatted under the lock, disable LOG_ASYNC_ENABLED and LOG_PARALLEL_FORMAT
+#        endif
+#        if (LOG_COMPRESS_ENABLED == 1U) || (LOG_DEFERRED_FORMAT == 1U)
+#            error Line in sink memory is written as is, disable LOG_COMPRESS_ENABLED and LOG_DEFERRED_FORMAT
+#        endif
+#        if LOG_COLLAPSE_REPEATS == 1U
+#            error LOG_COLLAPSE_REPEATS writes the notice before the reserved line, disable LOG_IO_RESERVE
+#        endif
+#    endif  // LOG_IO_RESERVE == 1U
+
+#    if LOG_IO_WRITE_ASYNC == 1U
+#        if (LOG_IO_BUFFERS < 2U) || ((LOG_IO_BUFFERS & (LOG_IO_BUFFERS - 1U)) != 0U) || (LOG_IO_BUFFER_SIZE < 64U)
+#            error LOG_IO_BUFFERS must be power of two, at least 2, LOG_IO_BUFFER_SIZE at least 64 bytes
+#        endif
+#        if (LOG_IO_RESERVE == 1U) || (LOG_IO_ATOMIC == 1U)
+#            error Buffers of LOG_IO_WRITE_ASYNC are filled under the lock, disable LOG_IO_RESERVE and LOG_IO_ATOMIC
+#        endif
+#    endif  // LOG_IO_WRITE_ASYNC == 1U
+
+/* Line is built on the stack of the caller, otherwise in the shared buffer under the lock */
+#    if (LOG_ASYNC_ENABLED == 1U) || (LOG_ISR_QUEUE == 1U) || (LOG_PARALLEL_FORMAT == 1U)
+#        define _LINE_ON_STACK (1U)
+#    else
+#        define _LINE_ON_STACK (0U)
+#    endif
+#    if (LOG_ASYNC_ENABLED == 0U) && (LOG_PARALLEL_FORMAT == 0U)
+#        define _LINE_SHARED (1U)
+#    else
+#        define _LINE_SHARED (0U)
+#    endif
+/* Lock is taken only to write the line which is already formatted */
+#    if (LOG_THREADSAFE_ENABLED == 1U) && (_LINE_SHARED == 0U) && (LOG_ASYNC_ENABLED == 0U) && (LOG_IO_ATOMIC == 0U)
+#        define _OUTPUT_LOCK (1U)
+#    else
+#        define _OUTPUT_LOCK (0U)
+#    endif
+
+#    if (LOG_ASYNC_ENABLED == 1U) || (LOG_ISR_QUEUE == 1U) || (_SINK_QUEUE_ENABLED == 1U)
+#        define _RING_ENABLED (1U)
+#    else
+#        define _RING_ENABLED (0U)
+#    endif
+
+#    if LOG_BACKPRESSURE_ENABLED == 1U
+#        if _RING_ENABLED == 0U
+#            error LOG_BACKPRESSURE_ENABLED works with queues, enable LOG_ASYNC_ENABLED, LOG_ISR_QUEUE or LOG_SINK_QUEUE_SIZE
+#        endif
+#        if LOG_BACKPRESSURE_RESERVE > 90U
+#            error LOG_BACKPRESSURE_RESERVE is percent of queue, up to 90
+#        endif
+/* Words of the queue which lines out of LOG_BACKPRESSURE_MASK may take */
+#        define _RING_LIMIT(WORDS) ((WORDS) - (((WORDS)*LOG_BACKPRESSURE_RESERVE) / 100U))
+#    endif  // LOG_BACKPRESSURE_ENABLED == 1U
+
+#    if _RING_ENABLED == 1U
+/* Record is header word and payload, header is zero until record is committed */
+#        define _RECORD_COMMITTED (0x80000000UL)
+#        define _RECORD_CLAIMED   (0x40000000UL)
+#        define _RECORD_PADDING   (0x20000000UL)
+/* Line of LOG_BACKPRESSURE_MASK level, LOG_ASYNC_OVERWRITE doesn't evict it */
+#        define _RECORD_RESERVED  (0x10000000UL)
+#        define _RECORD_SIZE_MASK (0x0000FFFFUL)
+
+/*
+    Positions are counted in words and wrap around, record is never split by the end of the ring,
+    size is power of two
+*/
+typedef struct {
+    atomic_uint *words;
+    uint32_t size;
+    bool is_overwrite;
+    bool is_color;
+    /* Sink which ring is drained to, NULL is io */
+    void (*write)(const uint8_t *data, size_t size);
+    atomic_uint head;
+    atomic_uint tail;
+    atomic_uint dropped;
+#        if LOG_BACKPRESSURE_ENABLED == 1U
+    uint32_t limit;
+    /* Lines rejected by the limit per level bit, reported when the queue is below it again */
+    atomic_uint shed[LOG_STATS_LEVELS];
+#        endif  // LOG_BACKPRESSURE_ENABLED == 1U
+} log_ring_t;
+#    endif  // _RING_ENABLED == 1U
+
+#    if LOG_IO_WRITE_ASYNC == 1U
+/*
+    Buffers are used in turn, counters wrap around: buffers from 'sent' to 'fill' are passed
+    to the sender, 'fill' is the active one. Active buffer is changed only by its owner,
+    LOG caller or log_write_complete() which takes it when nothing else is left to send
+*/
+typedef struct {
+    uint8_t data[LOG_IO_BUFFERS][LOG_IO_BUFFER_SIZE];
+    size_t sizes[LOG_IO_BUFFERS];
+    atomic_size_t len;
+    /* Lines of the active buffer and count of its dropped messages notice */
+    uint32_t lines;
+    uint32_t noticed;
+    uint32_t dropped;
+    atomic_uint fill;
+    atomic_uint sent;
+    atomic_bool is_owned;
+    /* Transfer is in flight, whoever sets it starts the next one */
+    atomic_bool is_busy;
+} log_tx_t;
+#    endif  // LOG_IO_WRITE_ASYNC == 1U
+
+#    if LOG_STATS_ENABLED == 1U
+/* Counters are relaxed atomics, they are updated without the lock and from interrupts */
+typedef struct {
+    atomic_uint emitted;
+    atomic_uint filtered;
+    atomic_uint bytes;
+    atomic_uint truncated;
+} log_level_counters_t;
+
+typedef struct {
+    log_level_counters_t levels[LOG_STATS_LEVELS];
+    atomic_uint snprintf_errors;
+    atomic_uint dropped;
+    atomic_uint write_time;
+    atomic_uint lock_time;
+} log_counters_t;
+
+#        define _STATS_ADD(COUNTER, VALUE) \
+            (void)atomic_fetch_add_explicit(&_ctx.stats.COUNTER, (uint32_t)(VALUE), memory_order_relaxed)
+#        if defined(LOG_STATS_CLOCK)
+#            define _STATS_CLOCK() ((uint32_t)LOG_STATS_CLOCK())
+#        elif LOG_TIMESTAMP_ENABLED == 1U
+#            define _STATS_CLOCK() ((uint32_t)_ctx.io->get_uptime_ms())
+#        else
+#            define _STATS_CLOCK() (0U)
+#        endif  // LOG_STATS_CLOCK
+#    else
+#        define _STATS_ADD(COUNTER, VALUE) ((void)(VALUE))
+#        define _STATS_CLOCK()             (0U)
+#    endif  // LOG_STATS_ENABLED == 1U
+
+#    if LOG_TIMERS_ENABLED == 1U
+#        if (LOG_TIMERS_MAX < 2U) || (LOG_TIMER_BUCKETS < 2U) || (LOG_TIMER_BUCKETS > 33U)
+#            error LOG_TIMERS_MAX must be at least 2, LOG_TIMER_BUCKETS from 2 to 33
+#        endif
+#        if !defined(LOG_TIMER_CLOCK) && (LOG_TIMESTAMP_ENABLED == 0U)
+#            error LOG_TIMERS_ENABLED needs LOG_TIMER_CLOCK or LOG_TIMESTAMP_ENABLED
+#        endif
+/* Relaxed atomics as counters of stats, call sites update them without the lock and from interrupts */
+struct log_timer_s {
+    const char *name;
+    atomic_uint count;
+    atomic_uint sum;
+    atomic_uint min;
+    atomic_uint max;
+    atomic_uint buckets[LOG_TIMER_BUCKETS];
+};
+#    endif  // LOG_TIMERS_ENABLED == 1U
+
+#    if LOG_TIMESTAMP_ENABLED == 1U
+#        if LOG_THROTTLES_MAX < 2U
+#            error LOG_THROTTLES_MAX must be at least 2
+#        endif
+/* LOG_EVERY_MS call site, time is uptime in ms, it's updated by the caller which lets message through */
+struct log_throttle_s {
+    atomic_uint last;
+    atomic_uint skipped;
+    log_mask_t level;
+    uint32_t period;
+};
+#    endif  // LOG_TIMESTAMP_ENABLED == 1U
+
+/* Line is collected here and sent by one write, it is flushed earlier only when it doesn't fit */
+typedef struct {
+    char *data;
+    size_t size;
+    size_t len;
+    log_mask_t mask;
+    /* Count of parts of the line written before its end */
+    uint32_t flushes;
+#    if LOG_SINKS_ENABLED == 1U
+    /* Timestamps in front of the line, sinks skip them according their style */
+    size_t date_len;
+    size_t uptime_len;
+#    endif  // LOG_SINKS_ENABLED == 1U
+#    if LOG_IO_RESERVE == 1U
+    /* Data points to memory of io->reserve */
+    bool is_reserved;
+#    endif  // LOG_IO_RESERVE == 1U
+#    if LOG_INSTANCES_ENABLED == 1U
+    /* Logger of the line, NULL - global one of log_init() */
+    log_instance_t *instance;
+#    endif  // LOG_INSTANCES_ENABLED == 1U
+} log_line_t;
+
+/* Output of _ftoa(), text goes to 'dst' of 'size' bytes as snprintf does or to the line when it's set */
+typedef struct {
+    char *dst;
+    size_t size;
+    size_t len;
+    log_line_t *line;
+} _ftoa_out_t;
+
+#    if LOG_BUILTIN_PRINTF == 1U
+/* Digits of m * 2^-1074 take 767 digits, 86 limbs */
+#        define _DEC_LIMBS (86U)
+
+/* Exact decimal value of double, limbs of 9 digits from the lowest one are scaled by 10^-shift */
+typedef struct {
+    uint32_t limbs[_DEC_LIMBS];
+    uint32_t count;
+    int32_t shift;
+    /* Power of ten of the first digit, 0 for zero */
+    int32_t top;
+} _dec_t;
+#    endif  // LOG_BUILTIN_PRINTF == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_FLOAT_DECIMALS > 9U
+#        error LOG_FLOAT_DECIMALS is limited by 9 digits
+#    endif
+
+static const char _HEX_DIGITS[] = "0123456789ABCDEF";
+static const uint32_t _POW10[] = { 1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL,
+                                   100000000UL, 1000000000UL };
+static const uint8_t SNPRINTF_ERROR[] = "\r\nsnprintf - internal error\r\n";
+static const uint8_t TRUNC_MESSAGE[] =
+    LOG_COLOR(LOG_COLOR_RED) "Message was truncated" LOG_ENDLINE "Increase LOG_MAX_MESSAGE_LENGTH" LOG_ENDLINE;
+
+/* Room for timestamps in front of the message */
+#    define _PREFIX_LENGTH (64U)
+#    define _LINE_LENGTH   (_PREFIX_LENGTH + LOG_MAX_MESSAGE_LENGTH + sizeof(LOG_ENDLINE) + sizeof(TRUNC_MESSAGE))
+
+#    if LOG_DEFERRED_FORMAT == 1U
+/* Room for text frame header in front of the line */
+#        define _LINE_HEADROOM (3U)
+#    else
+#        define _LINE_HEADROOM (0U)
+#    endif  // LOG_DEFERRED_FORMAT == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if (LOG_COMPRESS_ENABLED == 1U) || (LOG_COMPRESS_DECODER == 1U)
+#        if (LOG_COMPRESS_WINDOW < 256U) || (LOG_COMPRESS_WINDOW > 4096U) || \
+            ((LOG_COMPRESS_WINDOW & (LOG_COMPRESS_WINDOW - 1U)) != 0U)
+#            error LOG_COMPRESS_WINDOW must be power of two from 256 to 4096
+#        endif
+#        if LOG_MAX_MESSAGE_LENGTH > 16000U
+#            error Compressed block length is limited by 2 bytes, decrease LOG_MAX_MESSAGE_LENGTH
+#        endif
+
+/*
+    Block is header byte, 2 bytes payload length and LZSS payload: flags byte per 8 items,
+    item is literal byte or 16 bits match of distance and length. Window is kept between
+    blocks, reset block starts from the dictionary, decoder joins the stream by it
+*/
+#        define _BLOCK_MAGIC       (0xB0U)
+#        define _BLOCK_RESET       (0x01U)
+#        define _BLOCK_STORED      (0x02U)
+#        define _BLOCK_HEADER      (3U)
+#        define _BLOCK_INPUT       (3U + _LINE_LENGTH)
+#        define _BLOCK_MAX_PAYLOAD (_BLOCK_INPUT + (_BLOCK_INPUT / 8U) + 1U)
+
+#        define _LZ_MASK (LOG_COMPRESS_WINDOW - 1U)
+#        if LOG_COMPRESS_WINDOW == 256U
+#            define _LZ_DISTANCE_BITS (8U)
+#        elif LOG_COMPRESS_WINDOW == 512U
+#            define _LZ_DISTANCE_BITS (9U)
+#        elif LOG_COMPRESS_WINDOW == 1024U
+#            define _LZ_DISTANCE_BITS (10U)
+#        elif LOG_COMPRESS_WINDOW == 2048U
+#            define _LZ_DISTANCE_BITS (11U)
+#        else
+#            define _LZ_DISTANCE_BITS (12U)
+#        endif
+#        define _LZ_MIN_MATCH   (3U)
+#        define _LZ_MAX_MATCH   (_LZ_MIN_MATCH + (1U << (16U - _LZ_DISTANCE_BITS)) - 1U)
+#        define _LZ_HASH_SIZE   (LOG_COMPRESS_WINDOW / 4U)
+#        define _LZ_CHAIN_DEPTH (8U)
+
+typedef struct {
+    uint8_t window[LOG_COMPRESS_WINDOW];
+    uint32_t position;
+#        if LOG_COMPRESS_ENABLED == 1U
+    /* Hash chains of 3 bytes sequences, positions are truncated, candidates are verified by compare */
+    uint16_t head[_LZ_HASH_SIZE];
+    uint16_t prev[LOG_COMPRESS_WINDOW];
+    uint32_t since_reset;
+    uint8_t block[_BLOCK_HEADER + _BLOCK_MAX_PAYLOAD];
+#        else
+    bool is_synced;
+    uint8_t block[_BLOCK_INPUT];
+#        endif  // LOG_COMPRESS_ENABLED == 1U
+} log_lz_t;
+#    endif  // (LOG_COMPRESS_ENABLED == 1U) || (LOG_COMPRESS_DECODER == 1U)
+
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_MODULES_ENABLED == 1U
 typedef struct {
-    char buff[LOG_MAX_MESSAGE_LENGTH];
+    const char *name;
     log_mask_t mask;
+    bool is_set;
+} log_module_t;
+#    endif  // LOG_MODULES_ENABLED == 1U
+
+#    if LOG_SINKS_ENABLED == 1U
+typedef struct {
+    log_sink_t sink;
+#        if _SINK_QUEUE_ENABLED == 1U
+    log_ring_t queue;
+    atomic_uint words[LOG_SINK_QUEUE_SIZE / sizeof(uint32_t)];
+#        endif  // _SINK_QUEUE_ENABLED == 1U
+} log_sink_slot_t;
+#    endif  // LOG_SINKS_ENABLED == 1U
+
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+#    if _LINE_SHARED == 1U
+    char buff[_LINE_HEADROOM + _LINE_LENGTH];
+#    endif  // _LINE_SHARED == 1U
     log_io_t const *io;
-#    if LOG_ISR_QUEUE == 1U
-    uint8_t queue[LOG_ISR_MESSAGE_LENGTH];
-    size_t queue_index;
-#    endif  // LOG_ISR_QUEUE == 1U
+#    if LOG_COLLAPSE_REPEATS == 1U
+    uint32_t last_hash;
+    log_mask_t last_mask;
+    uint32_t repeats;
+    /* Text of the last message, longer one isn't kept and isn't collapsed */
+    char last_body[LOG_MAX_MESSAGE_LENGTH];
+    size_t last_size;
+#    endif  // LOG_COLLAPSE_REPEATS == 1U
+#    if LOG_MODULES_ENABLED == 1U
+    log_mask_t mask;
+    log_module_t modules[LOG_MODULES_MAX];
+    size_t modules_count;
+#    endif  // LOG_MODULES_ENABLED == 1U
+#    if (LOG_SINKS_ENABLED == 1U) || (LOG_RECORDER_ENABLED == 1U)
+    log_mask_t io_mask;
+#    endif  // (LOG_SINKS_ENABLED == 1U) || (LOG_RECORDER_ENABLED == 1U)
+#    if LOG_SINKS_ENABLED == 1U
+    log_sink_slot_t sinks[LOG_SINKS_MAX];
+    size_t sinks_count;
+#    endif  // LOG_SINKS_ENABLED == 1U
+#    if LOG_RECORDER_ENABLED == 1U
+    log_mask_t recorder_mask;
+    atomic_flag is_recording;
+#    endif  // LOG_RECORDER_ENABLED == 1U
+#    if (LOG_ASYNC_ENABLED == 1U) || (LOG_ISR_QUEUE == 1U)
+    log_ring_t ring;
+    atomic_uint ring_words[_RING_WORDS];
+#    endif  // (LOG_ASYNC_ENABLED == 1U) || (LOG_ISR_QUEUE == 1U)
+#    if (LOG_COMPRESS_ENABLED == 1U) || (LOG_COMPRESS_DECODER == 1U)
+    log_lz_t lz;
+#    endif  // (LOG_COMPRESS_ENABLED == 1U) || (LOG_COMPRESS_DECODER == 1U)
+#    if LOG_IO_WRITE_ASYNC == 1U
+    log_tx_t tx;
+#    endif  // LOG_IO_WRITE_ASYNC == 1U
+#    if (LOG_IO_FLUSH == 1U) && (LOG_ASYNC_ENABLED == 1U)
+    /* Line of LOG_IO_FLUSH_MASK is in the ring, log_process() flushes io after it */
+    atomic_bool is_flush_pending;
+#    endif  // (LOG_IO_FLUSH == 1U) && (LOG_ASYNC_ENABLED == 1U)
+#    if LOG_STATS_ENABLED == 1U
+    log_counters_t stats;
+#    endif  // LOG_STATS_ENABLED == 1U
+#    if LOG_TIMERS_ENABLED == 1U
+    /* Last one collects timers which don't fit the table */
+    log_timer_t timers[LOG_TIMERS_MAX];
+    atomic_uint timers_count;
+#    endif  // LOG_TIMERS_ENABLED == 1U
+#    if (LOG_TIMESTAMP_DELTA == 1U) && (LOG_TIMESTAMP_ENABLED == 1U)
+    log_stamp_t stamp;
+#    endif  // (LOG_TIMESTAMP_DELTA == 1U) && (LOG_TIMESTAMP_ENABLED == 1U)
+#    if LOG_TIMESTAMP_ENABLED == 1U
+    /* Last one is shared by sites which don't fit the table */
+    log_throttle_t throttles[LOG_THROTTLES_MAX];
+    atomic_uint throttles_count;
+    /* Some site has skipped messages which are not reported yet */
+    atomic_bool is_throttled;
+    atomic_flag is_reporting;
+#    endif  // LOG_TIMESTAMP_ENABLED == 1U
 } log_context_t;
 
+/* Exported for inline check in LOG macros */
+log_mask_t _log_mask = LOG_MASK_ALL;
+
 static log_context_t _ctx = {
+#    if _LINE_SHARED == 1U
     .buff = { 0 },
-    .mask = LOG_MASK_ALL,
+#    endif  // _LINE_SHARED == 1U
     .io = NULL,
-#    if LOG_ISR_QUEUE == 1U
-    .queue = { 0 },
-    .queue_index = 0,
-#    endif  // LOG_ISR_QUEUE == 1U
+#    if LOG_MODULES_ENABLED == 1U
+    .mask = LOG_MASK_ALL,
+    .modules_count = 0,
+#    endif  // LOG_MODULES_ENABLED == 1U
+#    if (LOG_SINKS_ENABLED == 1U) || (LOG_RECORDER_ENABLED == 1U)
+    .io_mask = LOG_MASK_ALL,
+#    endif  // (LOG_SINKS_ENABLED == 1U) || (LOG_RECORDER_ENABLED == 1U)
+#    if LOG_SINKS_ENABLED == 1U
+    .sinks_count = 0,
+#    endif  // LOG_SINKS_ENABLED == 1U
+#    if LOG_RECORDER_ENABLED == 1U
+    .recorder_mask = LOG_MASK_ALL,
+    .is_recording = ATOMIC_FLAG_INIT,
+#    endif  // LOG_RECORDER_ENABLED == 1U
+#    if LOG_TIMESTAMP_ENABLED == 1U
+    .is_reporting = ATOMIC_FLAG_INIT,
+#    endif  // LOG_TIMESTAMP_ENABLED == 1U
+#    if (LOG_ASYNC_ENABLED == 1U) || (LOG_ISR_QUEUE == 1U)
+    .ring = {
+        .words = _ctx.ring_words,
+        .size = _RING_WORDS,
+        .is_overwrite = (LOG_ASYNC_ENABLED == 1U) && (LOG_ASYNC_POLICY == LOG_ASYNC_OVERWRITE),
+        .is_color = true,
+        .write = NULL,
+#        if LOG_BACKPRESSURE_ENABLED == 1U
+        .limit = _RING_LIMIT(_RING_WORDS),
+#        endif  // LOG_BACKPRESSURE_ENABLED == 1U
+    },
+#    endif  // (LOG_ASYNC_ENABLED == 1U) || (LOG_ISR_QUEUE == 1U)
 };
 
-/* -------------------------------------------------------------------------- */
-
-static const uint8_t SNPRINTF_ERROR[] = "\r\nsnprintf - internal error\r\n";
+#    if LOG_RECORDER_ENABLED == 1U
+/* Not initialized on purpose, content of the previous run is kept by LOG_RECORDER_ATTRIBUTE */
+static log_recorder_t _recorder LOG_RECORDER_ATTRIBUTE;
+#    endif  // LOG_RECORDER_ENABLED == 1U
 
 /* -------------------------------------------------------------------------- */
 
-static inline void _log_to(uint8_t const *data, size_t size);
+static inline bool _log_write(log_mask_t level_mask, uint8_t const *data, size_t size);
+static void _io_write(uint8_t const *data, size_t size);
+static inline void _io_send(uint8_t const *data, size_t size);
+#    if LOG_IO_FLUSH == 1U
+static inline void _io_flush(log_mask_t level_mask);
+#    endif  // LOG_IO_FLUSH == 1U
+#    if LOG_IO_WRITE_ASYNC == 1U
+static void _tx_write(uint8_t const *data, size_t size);
+static bool _tx_put(log_tx_t *tx, uint8_t const *data, size_t size);
+static bool _tx_next(log_tx_t *tx);
+static void _tx_kick(log_tx_t *tx);
+#    endif  // LOG_IO_WRITE_ASYNC == 1U
+#    if _RING_ENABLED == 1U
+static void _log_writev(void (*write)(const uint8_t *data, size_t size), log_iovec_t const *iov, size_t count);
+#    endif  // _RING_ENABLED == 1U
 static void _log_format(log_mask_t level_mask, const char *format, va_list args, bool add_formating);
+static void _log_message(log_line_t *line, char *buff, const char *format, va_list args, bool add_formating);
+static void _log_finish(log_line_t *line, char *buff, size_t body, bool add_formating, bool is_truncated);
+#    if LOG_INSTANCES_ENABLED == 1U
+static void _instance_format(log_instance_t *instance, log_mask_t level_mask, const char *format, va_list args,
+                             bool add_formating);
+static inline log_line_t _instance_open(log_instance_t *instance, log_mask_t level_mask);
+#    endif  // LOG_INSTANCES_ENABLED == 1U
+
+#    if _SPEC_PARSER == 1U
+static const char *_parse_spec(const char *format, _format_spec_t *spec);
+#    endif  // (LOG_DEFERRED_FORMAT == 1U) || (LOG_DEFERRED_DECODER == 1U)
+
+#    if LOG_DEFERRED_FORMAT == 1U
+static uint8_t *_put_varint(uint8_t *dst, uint8_t const *end, uint64_t value);
+static bool _log_encode(char *buff, log_mask_t level_mask, const char *format, va_list args);
+#    endif  // LOG_DEFERRED_FORMAT == 1U
+
+#    if _RING_ENABLED == 1U
+static bool _ring_push(log_ring_t *ring, log_mask_t level_mask, uint8_t const *data, size_t size);
+static size_t _ring_drain(log_ring_t *ring, size_t budget);
+#        if LOG_BACKPRESSURE_ENABLED == 1U
+static void _ring_report_shed(log_ring_t *ring);
+#        endif  // LOG_BACKPRESSURE_ENABLED == 1U
+#    endif  // _RING_ENABLED == 1U
+
+#    if LOG_COLLAPSE_REPEATS == 1U
+static bool _log_is_repeat(log_mask_t level_mask, char const *body, size_t size);
+#    endif  // LOG_COLLAPSE_REPEATS == 1U
+
+#    if LOG_TIMESTAMP_ENABLED == 1U
+static log_throttle_t *_throttle_get(log_throttle_t **site, log_mask_t level_mask, uint32_t period_ms);
+static void _throttles_report(void);
+#    endif  // LOG_TIMESTAMP_ENABLED == 1U
+
+#    if LOG_MODULES_ENABLED == 1U
+static log_module_t *_module_get(const char *name);
+static void _module_update_mask(void);
+#    endif  // LOG_MODULES_ENABLED == 1U
+
+#    if LOG_SINKS_ENABLED == 1U
+static void _sinks_write(log_line_t *line, bool is_color);
+#        if LOG_ENABLED_COLOR == 1U
+static void _line_strip_colors(log_line_t *line);
+#        endif  // LOG_ENABLED_COLOR == 1U
+#    endif  // LOG_SINKS_ENABLED == 1U
+
+#    if LOG_RECORDER_ENABLED == 1U
+static void _recorder_open(void);
+static void _recorder_put(uint8_t const *data, size_t size);
+static uint32_t _recorder_checksum(uint32_t header, uint8_t const *data, size_t size);
+#    endif  // LOG_RECORDER_ENABLED == 1U
+
+#    if (LOG_SINKS_ENABLED == 1U) || (LOG_RECORDER_ENABLED == 1U)
+static log_mask_t _outputs_mask(void);
+#    endif  // (LOG_SINKS_ENABLED == 1U) || (LOG_RECORDER_ENABLED == 1U)
+static void _set_default_mask(log_mask_t level_mask);
+#    if (LOG_STATS_ENABLED == 1U) || (LOG_BACKPRESSURE_ENABLED == 1U)
+static inline uint32_t _stats_level(log_mask_t level_mask);
+#    endif  // (LOG_STATS_ENABLED == 1U) || (LOG_BACKPRESSURE_ENABLED == 1U)
+#    if (LOG_STATS_ENABLED == 1U) || (LOG_TIMERS_ENABLED == 1U)
+static inline uint32_t _stats_take(atomic_uint *counter, bool is_reset);
+#    endif  // (LOG_STATS_ENABLED == 1U) || (LOG_TIMERS_ENABLED == 1U)
+#    if LOG_TIMERS_ENABLED == 1U
+static log_timer_t *_timer_get(const char *name);
+static inline uint32_t _timer_bucket(uint32_t time);
+#    endif  // LOG_TIMERS_ENABLED == 1U
+
+#    if (LOG_COMPRESS_ENABLED == 1U) || (LOG_COMPRESS_DECODER == 1U)
+static void _lz_reset(log_lz_t *lz);
+#    endif  // (LOG_COMPRESS_ENABLED == 1U) || (LOG_COMPRESS_DECODER == 1U)
+#    if LOG_COMPRESS_ENABLED == 1U
+static inline uint32_t _lz_hash(uint8_t const *data);
+static size_t _lz_compress(log_lz_t *lz, uint8_t const *data, size_t size, uint8_t *dst);
+#    endif  // LOG_COMPRESS_ENABLED == 1U
+
+static inline char *_line_acquire(char *stack_buff);
+static inline void _line_release(char const *buff);
+static inline bool _output_lock(void);
+static inline void _output_unlock(bool is_locked);
+static inline log_line_t _line_open(char *buff, log_mask_t level_mask);
+static log_iovec_t _line_finish(log_line_t *line);
+static void _line_flush(log_line_t *line);
+static inline bool _line_write(log_line_t *line, uint8_t const *data, size_t size);
+#    if LOG_IO_RESERVE == 1U
+static void _line_reserve(log_line_t *line);
+#    endif  // LOG_IO_RESERVE == 1U
+static void _line_put(log_line_t *line, void const *data, size_t size);
+static void _line_commit(log_line_t *line, int len);
+static void _line_print(log_line_t *line, const char *format, ...);
+static void _line_prefix(log_line_t *line);
+static void _line_hex(log_line_t *line, uint8_t const *data, size_t size);
+static void _line_float(log_line_t *line, double value, uint32_t decimals);
+static void _ftoa(_ftoa_out_t *out, double value, uint32_t decimals);
+static int _ftoa_scale(uint64_t rest, uint32_t shift, uint32_t scale, uint64_t *fraction);
+#    if LOG_BUILTIN_PRINTF == 1U
+static void _line_vprint(log_line_t *line, const char *format, va_list args);
+static void _line_fill(log_line_t *line, char c, size_t count);
+static void _line_field(log_line_t *line, _format_spec_t const *spec, char const *prefix, size_t prefix_len,
+                        size_t zeros, char const *text, size_t size);
+static void _line_integer(log_line_t *line, _format_spec_t const *spec, uint64_t value, char sign);
+static void _line_double(log_line_t *line, _format_spec_t const *spec, double value);
+static void _line_decimal(log_line_t *line, _format_spec_t const *spec, char sign, _dec_t const *dec, bool is_exponent,
+                          uint32_t precision, bool is_trim);
+static void _line_fixed(log_line_t *line, _format_spec_t const *spec, char sign, double value, uint32_t decimals);
+static void _line_hex_double(log_line_t *line, _format_spec_t const *spec, char sign, double value);
+static void _dec_init(_dec_t *dec, double value);
+static inline uint32_t _dec_digit(_dec_t const *dec, int32_t power);
+static int32_t _dec_round(_dec_t const *dec, int32_t low);
+static int64_t _arg_signed(_length_t length, va_list *args);
+static uint64_t _arg_unsigned(_length_t length, va_list *args);
+#    endif  // LOG_BUILTIN_PRINTF == 1U
+static char *_put_uint(char *dst, uint64_t value, uint32_t digits);
+#    if LOG_TIMESTAMP_ENABLED == 1U
+static int _put_text(char *dst, size_t size, char const *text, size_t len);
+#    endif  // LOG_TIMESTAMP_ENABLED == 1U
 
 #    if LOG_TIMESTAMP_ENABLED == 1
-static inline void _print_uptime(void);
+static inline log_timestamp_t _stamp_now(log_io_t const *io);
+static inline int _print_uptime(char *dst, size_t size, log_timestamp_t ts);
+#        if LOG_TIMESTAMP_DELTA == 1U
+static int _print_stamp(char *dst, size_t size, log_timestamp_t ts, log_stamp_t *stamp);
+#        endif  // LOG_TIMESTAMP_DELTA == 1U
 #        if LOG_TIMESTAMP_FORMAT > 0U
-static inline void _print_date_time(void);
+static inline int _print_date_time(char *dst, size_t size, log_io_t const *io);
 #        endif  // LOG_TIMESTAMP_FORMAT > 0U
 #    endif      // LOG_TIMESTAMP_ENABLED == 1
 
@@ -61,9 +747,20 @@ static inline void _print_date_time(void);
 
 log_result_t log_init(const log_mask_t level_mask, log_io_t const *io) {
 
+#    if LOG_IO_WRITE_ASYNC == 1U
+    if ((io == NULL) || (io->write_async == NULL)) {
+        return LOGGER_RESULT_ERROR;
+    }
+#        if LOG_IO_BUFFER_POLICY == LOG_ASYNC_BLOCK
+    if (io->wait == NULL) {
+        return LOGGER_RESULT_ERROR;
+    }
+#        endif  // LOG_IO_BUFFER_POLICY == LOG_ASYNC_BLOCK
+#    else
     if ((io == NULL) || (io->write == NULL)) {
         return LOGGER_RESULT_ERROR;
     }
+#    endif  // LOG_IO_WRITE_ASYNC == 1U
 
 #    if LOG_TIMESTAMP_ENABLED == 1U
     if (io->get_uptime_ms == NULL) {
@@ -71,6 +768,12 @@ log_result_t log_init(const log_mask_t level_mask, log_io_t const *io) {
     }
 #    endif  // LOG_TIMESTAMP_ENABLED == 1U
 
+#    if LOG_TIMESTAMP_TICKS == 1U
+    if (io->get_ticks == NULL) {
+        return LOGGER_RESULT_ERROR;
+    }
+#    endif  // LOG_TIMESTAMP_TICKS == 1U
+
 #    if LOG_TIMESTAMP_FORMAT > 0U
     if (io->get_utc_time_s == NULL) {
         return LOGGER_RESULT_ERROR;
@@ -89,256 +792,3923 @@ log_result_t log_init(const log_mask_t level_mask, log_io_t const *io) {
     }
 #    endif  // LOG_ISR_QUEUE == 1U
 
-    _ctx.mask = level_mask;
-    _ctx.io = io;
-#    if LOG_ISR_QUEUE == 1U
-    _ctx.queue_index = 0;
-#    endif  // LOG_ISR_QUEUE == 1U
-
-    return LOGGER_RESULT_OK;
-}
-
-/* -------------------------------------------------------------------------- */
-
-static void _log_format(log_mask_t level_mask, const char *format, va_list args, bool add_formating) {
-#    if (LOG_TIMESTAMP_ENABLED == 0) && !defined(LOG_ENDLINE)
-    (void)add_formating;
-#    endif  // LOG_TIMESTAMP_ENABLED == 0
-    if ((level_mask & _ctx.mask) == 0) {
-        return;
+#    if LOG_IO_WRITEV == 1U
+    if (io->writev == NULL) {
+        return LOGGER_RESULT_ERROR;
     }
+#    endif  // LOG_IO_WRITEV == 1U
 
-#    if LOG_THREADSAFE_ENABLED == 1U
-    _ctx.io->lock();
-#    endif  // LOG_THREADSAFE_ENABLED == 1U
-
-#    if LOG_TIMESTAMP_ENABLED == 1
-    if (add_formating == true) {
-#        if LOG_TIMESTAMP_FORMAT > 0U
-        _print_date_time();
-#        endif  // LOG_TIMESTAMP_FORMAT > 0
-        _print_uptime();
+#    if LOG_IO_FLUSH == 1U
+    if (io->flush == NULL) {
+        return LOGGER_RESULT_ERROR;
     }
-#    endif  // LOG_TIMESTAMP_ENABLED == 1
+#    endif  // LOG_IO_FLUSH == 1U
 
-    bool is_truncated = false;
-    int len = vsnprintf(_ctx.buff, LOG_MAX_MESSAGE_LENGTH, format, args);
-    if (len >= (int)LOG_MAX_MESSAGE_LENGTH) {
-        len = LOG_MAX_MESSAGE_LENGTH;
-        is_truncated = true;
-    }
-    if (len >= 0) {
-        _log_to((uint8_t *)_ctx.buff, (size_t)len);
-    } else {
-        _log_to(SNPRINTF_ERROR, sizeof(SNPRINTF_ERROR) - 1);
-    }
-#    if defined(LOG_ENDLINE)
-    if (add_formating == true) {
-        _log_to((uint8_t const *)LOG_ENDLINE, sizeof(LOG_ENDLINE) - 1);
-    }
-#    endif  // LOG_ENDLINE
-    if (is_truncated == true) {
-        static const uint8_t TRUNC_MESSAGE[] =
-            LOG_COLOR(LOG_COLOR_RED) "Message was truncated" LOG_ENDLINE "Increase LOG_MAX_MESSAGE_LENGTH" LOG_ENDLINE;
-        _log_to(TRUNC_MESSAGE, sizeof(TRUNC_MESSAGE) - 1);
+#    if LOG_IO_RESERVE == 1U
+    if ((io->reserve == NULL) || (io->commit == NULL)) {
+        return LOGGER_RESULT_ERROR;
     }
+#    endif  // LOG_IO_RESERVE == 1U
 
-#    if LOG_THREADSAFE_ENABLED == 1U
-    _ctx.io->unlock();
-#    endif  // LOG_THREADSAFE_ENABLED == 1U
+    _ctx.io = io;
+#    if LOG_COMPRESS_ENABLED == 1U
+    _ctx.lz.since_reset = LOG_COMPRESS_SYNC_INTERVAL; /* Stream starts by reset block */
+#    endif  // LOG_COMPRESS_ENABLED == 1U
+#    if LOG_RECORDER_ENABLED == 1U
+    _recorder_open();
+#    endif  // LOG_RECORDER_ENABLED == 1U
+#    if (LOG_SINKS_ENABLED == 1U) || (LOG_RECORDER_ENABLED == 1U)
+    _ctx.io_mask = level_mask;
+    _set_default_mask(_outputs_mask());
+#    else
+    _set_default_mask(level_mask);
+#    endif  // (LOG_SINKS_ENABLED == 1U) || (LOG_RECORDER_ENABLED == 1U)
+
+    return LOGGER_RESULT_OK;
 }
 
 /* -------------------------------------------------------------------------- */
 
-void log_it(log_mask_t level_mask, const char *format, ...) {
-    va_list args;
-    va_start(args, format);
-    _log_format(level_mask, format, args, true);
-    va_end(args);
+#    if (LOG_SINKS_ENABLED == 1U) || (LOG_RECORDER_ENABLED == 1U)
+
+/* Levels which are written anywhere, mask of log_init() is mask of io->write only */
+static log_mask_t _outputs_mask(void) {
+    log_mask_t level_mask = _ctx.io_mask;
+#        if LOG_SINKS_ENABLED == 1U
+    for (size_t i = 0; i < _ctx.sinks_count; i++) {
+        level_mask |= _ctx.sinks[i].sink.mask;
+    }
+#        endif  // LOG_SINKS_ENABLED == 1U
+#        if LOG_RECORDER_ENABLED == 1U
+    level_mask |= _ctx.recorder_mask;
+#        endif  // LOG_RECORDER_ENABLED == 1U
+    return level_mask;
 }
 
+#    endif  // (LOG_SINKS_ENABLED == 1U) || (LOG_RECORDER_ENABLED == 1U)
+
 /* -------------------------------------------------------------------------- */
 
-void log_raw(const log_mask_t level_mask, const char *format, ...) {
-    va_list args;
-    va_start(args, format);
-    _log_format(level_mask, format, args, false);
-    va_end(args);
+/* Mask of modules which were not set, without modules it is the only mask */
+static void _set_default_mask(log_mask_t level_mask) {
+#    if LOG_MODULES_ENABLED == 1U
+    _ctx.mask = level_mask;
+    for (size_t i = 0; i < _ctx.modules_count; i++) {
+        if (_ctx.modules[i].is_set == false) {
+            _ctx.modules[i].mask = level_mask;
+        }
+    }
+    _module_update_mask();
+#    else
+    _log_mask = level_mask;
+#    endif  // LOG_MODULES_ENABLED == 1U
 }
 
 /* -------------------------------------------------------------------------- */
 
-void log_array(log_mask_t level_mask, const char *message, const void *data, size_t size) {
-    if ((level_mask & _ctx.mask) == 0) {
-        return;
-    }
-    uint8_t const *array = (uint8_t const *)data;
-#    if LOG_THREADSAFE_ENABLED == 1U
-    _ctx.io->lock();
-#    endif  // LOG_THREADSAFE_ENABLED == 1U
+#    if LOG_STATS_ENABLED == 1U
 
-#    if LOG_TIMESTAMP_ENABLED == 1
-#        if LOG_TIMESTAMP_FORMAT > 0U
-    _print_date_time();
-#        endif  // LOG_TIMESTAMP_FORMAT > 0
-    _print_uptime();
-#    endif  // LOG_TIMESTAMP_ENABLED == 1
-    int len = snprintf(_ctx.buff, sizeof(_ctx.buff), "%s[%zu]:", message, size);
-    if (len >= 0) {
-        _log_to((uint8_t *)_ctx.buff, (size_t)len);
-    } else {
-        _log_to(SNPRINTF_ERROR, sizeof(SNPRINTF_ERROR) - 1);
+log_result_t log_get_stats(log_stats_t *stats, bool is_reset) {
+    if (stats == NULL) {
+        return LOGGER_RESULT_ERROR;
     }
 
-    for (size_t i = 0; i < size; i++) {
-        len = snprintf(_ctx.buff, sizeof(_ctx.buff), " %02X", array[i]);
-        if (len >= 0) {
-            _log_to((uint8_t *)_ctx.buff, (size_t)len);
-        } else {
-            _log_to(SNPRINTF_ERROR, sizeof(SNPRINTF_ERROR) - 1);
-        }
+    for (size_t i = 0; i < LOG_STATS_LEVELS; i++) {
+        log_level_counters_t *level = &_ctx.stats.levels[i];
+        stats->levels[i].emitted = _stats_take(&level->emitted, is_reset);
+        stats->levels[i].filtered = _stats_take(&level->filtered, is_reset);
+        stats->levels[i].bytes = _stats_take(&level->bytes, is_reset);
+        stats->levels[i].truncated = _stats_take(&level->truncated, is_reset);
     }
-    _log_to((uint8_t const *)LOG_ENDLINE, sizeof(LOG_ENDLINE) - 1);
+    stats->snprintf_errors = _stats_take(&_ctx.stats.snprintf_errors, is_reset);
+    stats->dropped = _stats_take(&_ctx.stats.dropped, is_reset);
+    stats->write_time = _stats_take(&_ctx.stats.write_time, is_reset);
+    stats->lock_time = _stats_take(&_ctx.stats.lock_time, is_reset);
 
-#    if LOG_THREADSAFE_ENABLED == 1U
-    _ctx.io->unlock();
-#    endif  // LOG_THREADSAFE_ENABLED == 1U
+    return LOGGER_RESULT_OK;
 }
 
 /* -------------------------------------------------------------------------- */
 
-void log_array_float(log_mask_t level_mask, const char *message, const float *array, size_t size) {
-    if ((level_mask & _ctx.mask) == 0) {
-        return;
-    }
+void _log_stats_filtered(log_mask_t level_mask) {
+    _STATS_ADD(levels[_stats_level(level_mask)].filtered, 1U);
+}
 
-#    if LOG_THREADSAFE_ENABLED == 1U
-    _ctx.io->lock();
-#    endif  // LOG_THREADSAFE_ENABLED == 1U
+#    endif  // LOG_STATS_ENABLED == 1U
 
-#    if LOG_TIMESTAMP_ENABLED == 1
-#        if LOG_TIMESTAMP_FORMAT > 0U
-    _print_date_time();
-#        endif  // LOG_TIMESTAMP_FORMAT > 0
-    _print_uptime();
-#    endif  // LOG_TIMESTAMP_ENABLED == 1
-    int len = snprintf(_ctx.buff, sizeof(_ctx.buff), "%s[%zu]:", message, size);
-    if (len >= 0) {
-        _log_to((uint8_t *)_ctx.buff, (size_t)len);
-    } else {
-        _log_to(SNPRINTF_ERROR, sizeof(SNPRINTF_ERROR) - 1);
-    }
+/* -------------------------------------------------------------------------- */
 
-    for (size_t i = 0; i < size; i++) {
-        len = snprintf(_ctx.buff, sizeof(_ctx.buff), " %.2f", array[i]);
-        if (len >= 0) {
-            _log_to((uint8_t *)_ctx.buff, (size_t)len);
-        } else {
-            _log_to(SNPRINTF_ERROR, sizeof(SNPRINTF_ERROR) - 1);
-        }
-    }
-    _log_to((uint8_t const *)LOG_ENDLINE, sizeof(LOG_ENDLINE) - 1);
+#    if (LOG_STATS_ENABLED == 1U) || (LOG_BACKPRESSURE_ENABLED == 1U)
 
-#    if LOG_THREADSAFE_ENABLED == 1U
-    _ctx.io->unlock();
-#    endif  // LOG_THREADSAFE_ENABLED == 1U
+/* Counters of line with several levels go to the lowest one */
+static inline uint32_t _stats_level(log_mask_t level_mask) {
+    uint32_t index = 0;
+    while ((index < (LOG_STATS_LEVELS - 1U)) && ((level_mask & (1U << index)) == 0)) {
+        index++;
+    }
+    return index;
 }
 
+#    endif  // (LOG_STATS_ENABLED == 1U) || (LOG_BACKPRESSURE_ENABLED == 1U)
+
 /* -------------------------------------------------------------------------- */
 
-#    if LOG_ISR_QUEUE == 1U
+#    if (LOG_STATS_ENABLED == 1U) || (LOG_TIMERS_ENABLED == 1U)
 
-void log_flush_isr_queue(void) {
-    if (_ctx.queue_index > 0) {
-        _ctx.io->write((uint8_t const *)LOG_ENDLINE, sizeof(LOG_ENDLINE) - 1);
-        _ctx.io->write(_ctx.queue, _ctx.queue_index);
-        _ctx.queue_index = 0;
-        _ctx.io->write((uint8_t const *)LOG_ENDLINE, sizeof(LOG_ENDLINE) - 1);
+/* Counter is taken and cleared at once, so nothing is lost between read and reset */
+static inline uint32_t _stats_take(atomic_uint *counter, bool is_reset) {
+    if (is_reset == true) {
+        return atomic_exchange_explicit(counter, 0, memory_order_relaxed);
     }
+    return atomic_load_explicit(counter, memory_order_relaxed);
 }
 
-#    endif  // LOG_ISR_QUEUE == 1U
+#    endif  // (LOG_STATS_ENABLED == 1U) || (LOG_TIMERS_ENABLED == 1U)
 
 /* -------------------------------------------------------------------------- */
 
-static inline void _log_to(uint8_t const *data, size_t size) {
-#    if LOG_ISR_QUEUE == 1U
-    if (_ctx.io->is_isr()) {
-        for (size_t i = 0; i < size; i++) {
-            if (_ctx.queue_index >= sizeof(_ctx.queue)) {
-                return;
-            }
-            _ctx.queue[_ctx.queue_index] = data[i];
-            _ctx.queue_index++;
-        }
-        return;
-    }
-    log_flush_isr_queue();
-#    endif  // LOG_ISR_QUEUE == 1U
+#    if LOG_TIMERS_ENABLED == 1U
 
-    _ctx.io->write(data, size);
+uint32_t _log_timer_now(void) {
+#        if defined(LOG_TIMER_CLOCK)
+    return (uint32_t)LOG_TIMER_CLOCK();
+#        else
+    if (_ctx.io == NULL) {
+        return 0;
+    }
+#            if LOG_TIMESTAMP_TICKS == 1U
+    return (uint32_t)_ctx.io->get_ticks();
+#            else
+    return (uint32_t)_ctx.io->get_uptime_ms();
+#            endif  // LOG_TIMESTAMP_TICKS == 1U
+#        endif      // LOG_TIMER_CLOCK
 }
 
 /* -------------------------------------------------------------------------- */
 
-#    if LOG_TIMESTAMP_ENABLED == 1
+/* Recording is a few relaxed atomic adds, min and max are exchanged only when they change */
+void _log_scope_end(log_scope_t *scope) {
+    uint32_t time = _LOG_TIMER_NOW() - scope->start;
 
-static inline void _print_uptime(void) {
-#        if LOG_TIMESTAMP_64BIT == 0
-#            define _FORMAT "[%04" PRIi32 ".%03" PRIu32 "] "
-#        else
-#            define _FORMAT "[%04" PRIi64 ".%03" PRIu32 "] "
-#        endif  // LOG_TIMESTAMP_64BIT == 1
+    log_timer_t *timer = *scope->site;
+    if (timer == NULL) {
+        timer = _timer_get(scope->name);
+        if (timer == NULL) {
+            return;
+        }
+        *scope->site = timer;
+    }
 
-    static const log_timestamp_t _DIVIDER = 1000UL;
-    log_timestamp_t ts = _ctx.io->get_uptime_ms();
+    atomic_fetch_add_explicit(&timer->count, 1U, memory_order_relaxed);
+    atomic_fetch_add_explicit(&timer->sum, time, memory_order_relaxed);
+    atomic_fetch_add_explicit(&timer->buckets[_timer_bucket(time)], 1U, memory_order_relaxed);
 
-    log_timestamp_t sec = (ts / _DIVIDER);
-    uint32_t msec = (uint32_t)(ts % _DIVIDER);
-    int len = snprintf(_ctx.buff, sizeof(_ctx.buff), _TIMESTAMP_COLOR _FORMAT, sec, msec);
-    if (len >= 0) {
-        _log_to((uint8_t *)_ctx.buff, (size_t)len);
-    } else {
-        _log_to(SNPRINTF_ERROR, sizeof(SNPRINTF_ERROR) - 1);
+    uint32_t min = atomic_load_explicit(&timer->min, memory_order_relaxed);
+    while ((time < min) &&
+           (atomic_compare_exchange_weak_explicit(&timer->min, &min, time, memory_order_relaxed,
+                                                  memory_order_relaxed) == false)) {
+    }
+    uint32_t max = atomic_load_explicit(&timer->max, memory_order_relaxed);
+    while ((time > max) &&
+           (atomic_compare_exchange_weak_explicit(&timer->max, &max, time, memory_order_relaxed,
+                                                  memory_order_relaxed) == false)) {
     }
 }
 
 /* -------------------------------------------------------------------------- */
 
-#        if LOG_TIMESTAMP_FORMAT > 0U
-static inline void _print_date_time(void) {
-    time_t utc_time = _ctx.io->get_utc_time_s();
-    struct tm tm_buffer;
-#            if defined(_MSC_VER)
-    gmtime_s(&tm_buffer, &utc_time);
-#            else
-    gmtime_r(&utc_time, &tm_buffer);
-#            endif
+void log_dump_timers(const log_mask_t level_mask, bool is_reset) {
+    uint32_t count = atomic_load_explicit(&_ctx.timers_count, memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++) {
+        log_timer_t *timer = &_ctx.timers[i];
+        uint32_t calls = _stats_take(&timer->count, is_reset);
+        uint32_t sum = _stats_take(&timer->sum, is_reset);
+        uint32_t min = (is_reset == true) ? atomic_exchange_explicit(&timer->min, UINT32_MAX, memory_order_relaxed)
+                                          : atomic_load_explicit(&timer->min, memory_order_relaxed);
+        uint32_t max = _stats_take(&timer->max, is_reset);
+        uint32_t buckets[LOG_TIMER_BUCKETS];
+        for (uint32_t j = 0; j < LOG_TIMER_BUCKETS; j++) {
+            buckets[j] = _stats_take(&timer->buckets[j], is_reset);
+        }
 
-#            if LOG_TIMESTAMP_FORMAT == 1U
-    int len = snprintf(_ctx.buff,
-                       sizeof(_ctx.buff),
-                       _TIMESTAMP_COLOR "[%02" PRIu32 ":%02" PRIu32 ":%02" PRIu32 "] ",
-                       (uint32_t)tm_buffer.tm_hour,
-                       (uint32_t)tm_buffer.tm_min,
-                       (uint32_t)tm_buffer.tm_sec);
-#            else
-    int len = snprintf(_ctx.buff,
-                       sizeof(_ctx.buff),
-                       _TIMESTAMP_COLOR "[%04" PRIu32 "-%02" PRIu32 "-%02" PRIu32 " %02" PRIu32 ":%02" PRIu32
-                                        ":%02" PRIu32 "] ",
-                       (uint32_t)(tm_buffer.tm_year + 1900),
-                       (uint32_t)(tm_buffer.tm_mon + 1),
-                       (uint32_t)tm_buffer.tm_mday,
-                       (uint32_t)tm_buffer.tm_hour,
-                       (uint32_t)tm_buffer.tm_min,
-                       (uint32_t)tm_buffer.tm_sec);
-#            endif  // LOG_TIMESTAMP_FORMAT == 1U
-    if (len >= 0) {
-        _log_to((uint8_t *)_ctx.buff, (size_t)len);
-    } else {
-        _log_to(SNPRINTF_ERROR, sizeof(SNPRINTF_ERROR) - 1);
-    }
+        if (calls == 0) {
+            log_it(level_mask, "Timer %s: count 0", timer->name);
+            continue;
+        }
+        log_it(level_mask, "Timer %s: count %" PRIu32 " min %" PRIu32 " mean %" PRIu32 " max %" PRIu32, timer->name,
+               calls, min, sum / calls, max);
+
+        /* Only buckets from the first to the last used one, count and buckets aren't taken at once */
+        uint32_t first = 0;
+        uint32_t last = LOG_TIMER_BUCKETS - 1U;
+        while ((first < LOG_TIMER_BUCKETS) && (buckets[first] == 0)) {
+            first++;
+        }
+        if (first == LOG_TIMER_BUCKETS) {
+            continue;
+        }
+        while ((last > first) && (buckets[last] == 0)) {
+            last--;
+        }
+        char text[LOG_MAX_MESSAGE_LENGTH];
+        size_t len = 0;
+        for (uint32_t j = first; (j <= last) && ((len + 24U) < sizeof(text)); j++) {
+            char *end = &text[len];
+            *end++ = ' ';
+            if (j < (LOG_TIMER_BUCKETS - 1U)) {
+                *end++ = '<';
+                end = _put_uint(end, (uint64_t)1U << j, 0);
+            } else {
+                *end++ = '>';
+                *end++ = '=';
+                end = _put_uint(end, (uint64_t)1U << (j - 1U), 0);
+            }
+            *end++ = ':';
+            end = _put_uint(end, buckets[j], 0);
+            len = (size_t)(end - text);
+        }
+        text[len] = '\0';
+        log_it(level_mask, "Timer %s:%s", timer->name, text);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Bucket N > 0 counts times from 2^(N-1) to 2^N - 1, the last one counts all longer times */
+static inline uint32_t _timer_bucket(uint32_t time) {
+    uint32_t bucket = 0;
+#        if defined(__GNUC__)
+    bucket = (time != 0) ? (32U - (uint32_t)__builtin_clz(time)) : 0U;
+#        else
+    while (time != 0) {
+        bucket++;
+        time >>= 1U;
+    }
+#        endif  // __GNUC__
+    return (bucket < LOG_TIMER_BUCKETS) ? bucket : (LOG_TIMER_BUCKETS - 1U);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Finds timer by name, registers it if it's new, the last slot is shared by timers which don't fit */
+static log_timer_t *_timer_get(const char *name) {
+    /* Timer isn't recorded before log_init(), interrupt doesn't wait for the lock */
+    if (_ctx.io == NULL) {
+        return NULL;
+    }
+#        if LOG_THREADSAFE_ENABLED == 1U
+#            if LOG_ISR_QUEUE == 1U
+    bool is_locked = (_ctx.io->is_isr() == false);
+#            else
+    bool is_locked = true;
+#            endif  // LOG_ISR_QUEUE == 1U
+    if (is_locked == true) {
+        _ctx.io->lock();
+    }
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+
+    log_timer_t *timer = NULL;
+    uint32_t count = atomic_load_explicit(&_ctx.timers_count, memory_order_relaxed);
+    for (uint32_t i = 0; (i < count) && (timer == NULL); i++) {
+        if (strcmp(_ctx.timers[i].name, name) == 0) {
+            timer = &_ctx.timers[i];
+        }
+    }
+    if ((timer == NULL) && (count == LOG_TIMERS_MAX)) {
+        timer = &_ctx.timers[LOG_TIMERS_MAX - 1U];
+    }
+    if (timer == NULL) {
+        timer = &_ctx.timers[count];
+        timer->name = (count == (LOG_TIMERS_MAX - 1U)) ? "others" : name;
+        atomic_store_explicit(&timer->min, UINT32_MAX, memory_order_relaxed);
+        atomic_store_explicit(&_ctx.timers_count, count + 1U, memory_order_release);
+    }
+
+#        if LOG_THREADSAFE_ENABLED == 1U
+    if (is_locked == true) {
+        _ctx.io->unlock();
+    }
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+    return timer;
+}
+
+#    endif  // LOG_TIMERS_ENABLED == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_SINKS_ENABLED == 1U
+
+log_result_t log_add_sink(log_sink_t const *sink) {
+    if ((_ctx.io == NULL) || (sink == NULL) || (sink->write == NULL)) {
+        return LOGGER_RESULT_ERROR;
+    }
+#        if _SINK_QUEUE_ENABLED == 0U
+    if (sink->is_queued == true) {
+        return LOGGER_RESULT_ERROR;
+    }
+#        endif  // _SINK_QUEUE_ENABLED == 0U
+
+#        if LOG_THREADSAFE_ENABLED == 1U
+    _ctx.io->lock();
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+    bool is_added = (_ctx.sinks_count < LOG_SINKS_MAX);
+    if (is_added == true) {
+        log_sink_slot_t *slot = &_ctx.sinks[_ctx.sinks_count];
+        slot->sink = *sink;
+#        if _SINK_QUEUE_ENABLED == 1U
+        slot->queue.words = slot->words;
+        slot->queue.size = LOG_SINK_QUEUE_SIZE / sizeof(uint32_t);
+        slot->queue.is_overwrite = (LOG_ASYNC_POLICY == LOG_ASYNC_OVERWRITE);
+        slot->queue.is_color = sink->is_color;
+        slot->queue.write = sink->write;
+#            if LOG_BACKPRESSURE_ENABLED == 1U
+        slot->queue.limit = _RING_LIMIT(slot->queue.size);
+#            endif  // LOG_BACKPRESSURE_ENABLED == 1U
+#        endif  // _SINK_QUEUE_ENABLED == 1U
+        _ctx.sinks_count++;
+        _set_default_mask(_outputs_mask());
+    }
+#        if LOG_THREADSAFE_ENABLED == 1U
+    _ctx.io->unlock();
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+
+    return (is_added == true) ? LOGGER_RESULT_OK : LOGGER_RESULT_ERROR;
+}
+
+#    endif  // LOG_SINKS_ENABLED == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_RECORDER_ENABLED == 1U
+
+log_result_t log_recorder_set_mask(const log_mask_t level_mask) {
+    if (_ctx.io == NULL) {
+        return LOGGER_RESULT_ERROR;
+    }
+
+#        if LOG_THREADSAFE_ENABLED == 1U
+    _ctx.io->lock();
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+    _ctx.recorder_mask = level_mask;
+    _set_default_mask(_outputs_mask());
+#        if LOG_THREADSAFE_ENABLED == 1U
+    _ctx.io->unlock();
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+
+    return LOGGER_RESULT_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static inline uint32_t _recorder_header(uint32_t position, size_t size) {
+    uint32_t tag = ((position >> 2) ^ _RECORDER_MAGIC) & 0xFFFFU;
+    return ((tag ^ (uint32_t)size) << 16) | (uint32_t)size;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Returns bytes taken by record at 'position', zero if header is broken */
+static uint32_t _recorder_record_size(uint32_t position) {
+    uint32_t header = 0;
+    memcpy(&header, &_recorder.data[position & (LOG_RECORDER_SIZE - 1U)], sizeof(header));
+    size_t size = header & 0xFFFFU;
+    if ((size == 0) || (size > _RECORDER_MAX_LINE) || (header != _recorder_header(position, size))) {
+        return 0;
+    }
+    return _RECORDER_OVERHEAD + (((uint32_t)size + 3U) & ~3U);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static uint32_t _recorder_checksum(uint32_t header, uint8_t const *data, size_t size) {
+    uint32_t hash = 2166136261UL ^ header;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Keeps records of the previous run, buffer with broken header is taken as not initialized RAM */
+static void _recorder_open(void) {
+    if ((_recorder.magic != _RECORDER_MAGIC) || (_recorder.size != LOG_RECORDER_SIZE) ||
+        ((_recorder.head - _recorder.tail) > LOG_RECORDER_SIZE) || ((_recorder.head & 3U) != 0) ||
+        ((_recorder.tail & 3U) != 0)) {
+        _recorder.head = 0;
+        _recorder.tail = 0;
+        _recorder.size = LOG_RECORDER_SIZE;
+        _recorder.magic = _RECORDER_MAGIC;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Copies line to the buffer, the oldest records are dropped to get room */
+static void _recorder_put(uint8_t const *data, size_t size) {
+    if (atomic_flag_test_and_set_explicit(&_ctx.is_recording, memory_order_acquire) == true) {
+        return; /* Interrupt or other thread of asynchronous mode is recording, line is skipped */
+    }
+
+    if (size > _RECORDER_MAX_LINE) {
+        size = _RECORDER_MAX_LINE;
+    }
+    uint32_t record_size = _RECORDER_OVERHEAD + (((uint32_t)size + 3U) & ~3U);
+    uint32_t head = _recorder.head;
+    uint32_t tail = _recorder.tail;
+    while ((head + record_size - tail) > LOG_RECORDER_SIZE) {
+        uint32_t dropped = _recorder_record_size(tail);
+        if (dropped == 0) {
+            tail = head; /* Broken record, nothing after it can be trusted */
+            break;
+        }
+        tail += dropped;
+    }
+    /* Tail is moved before its records are overwritten, so buffer stays valid if it is interrupted by reset */
+    _recorder.tail = tail;
+
+    uint32_t header = _recorder_header(head, size);
+    uint32_t checksum = _recorder_checksum(header, data, size);
+    memcpy(&_recorder.data[head & (LOG_RECORDER_SIZE - 1U)], &header, sizeof(header));
+    memcpy(&_recorder.data[(head + sizeof(header)) & (LOG_RECORDER_SIZE - 1U)], &checksum, sizeof(checksum));
+    uint32_t index = (head + _RECORDER_OVERHEAD) & (LOG_RECORDER_SIZE - 1U);
+    size_t count = ((index + size) > LOG_RECORDER_SIZE) ? (LOG_RECORDER_SIZE - index) : size;
+    memcpy(&_recorder.data[index], data, count);
+    memcpy(&_recorder.data[0], &data[count], size - count);
+    _recorder.head = head + record_size;
+
+    atomic_flag_clear_explicit(&_ctx.is_recording, memory_order_release);
+}
+
+/* -------------------------------------------------------------------------- */
+
+log_result_t log_recorder_dump(void) {
+    if (_ctx.io == NULL) {
+        return LOGGER_RESULT_ERROR;
+    }
+    static const uint8_t BEGIN[] = LOG_COLOR(LOG_COLOR_CYAN) "Flight recorder begin" LOG_ENDLINE;
+    static const uint8_t END[] = LOG_COLOR(LOG_COLOR_CYAN) "Flight recorder end" LOG_ENDLINE;
+    static const uint8_t CORRUPTED[] = LOG_COLOR(LOG_COLOR_RED) "Flight recorder is corrupted" LOG_ENDLINE;
+    static const char SKIPPED[] = LOG_COLOR(LOG_COLOR_RED) "Flight recorder skipped ";
+    static const char SKIPPED_END[] = " records with bad checksum" LOG_ENDLINE;
+
+#        if _LINE_ON_STACK == 1U
+    char stack_buff[_LINE_HEADROOM + _LINE_LENGTH];
+#        else
+    char *stack_buff = NULL;
+#        endif  // _LINE_ON_STACK == 1U
+    char *buff = _line_acquire(stack_buff);
+    bool is_locked = _output_lock();
+    while (atomic_flag_test_and_set_explicit(&_ctx.is_recording, memory_order_acquire) == true) {
+    }
+
+    /* Records are written directly to io, so buffer larger than asynchronous ring isn't lost */
+    _io_write(BEGIN, sizeof(BEGIN) - 1U);
+    uint32_t position = _recorder.tail;
+    uint32_t skipped = 0;
+    while (position != _recorder.head) {
+        uint32_t record_size = _recorder_record_size(position);
+        if ((record_size == 0) || ((_recorder.head - position) < record_size)) {
+            break;
+        }
+
+        uint32_t header = 0;
+        uint32_t checksum = 0;
+        memcpy(&header, &_recorder.data[position & (LOG_RECORDER_SIZE - 1U)], sizeof(header));
+        memcpy(&checksum, &_recorder.data[(position + sizeof(header)) & (LOG_RECORDER_SIZE - 1U)], sizeof(checksum));
+        size_t size = header & 0xFFFFU;
+        uint32_t index = (position + _RECORDER_OVERHEAD) & (LOG_RECORDER_SIZE - 1U);
+        size_t count = ((index + size) > LOG_RECORDER_SIZE) ? (LOG_RECORDER_SIZE - index) : size;
+        memcpy(buff, &_recorder.data[index], count);
+        memcpy(&buff[count], &_recorder.data[0], size - count);
+        /* Header gives the next record, so only the line with damaged text is skipped */
+        if (_recorder_checksum(header, (uint8_t const *)buff, size) == checksum) {
+            _io_write((uint8_t const *)buff, size);
+        } else {
+            skipped++;
+        }
+        position += record_size;
+    }
+
+    bool is_valid = (position == _recorder.head);
+    if (is_valid == false) {
+        _io_write(CORRUPTED, sizeof(CORRUPTED) - 1U);
+        _recorder.tail = _recorder.head;
+    }
+    if (skipped > 0) {
+        char *end = buff;
+        memcpy(end, SKIPPED, sizeof(SKIPPED) - 1U);
+        end = _put_uint(end + sizeof(SKIPPED) - 1U, skipped, 0);
+        memcpy(end, SKIPPED_END, sizeof(SKIPPED_END) - 1U);
+        end += sizeof(SKIPPED_END) - 1U;
+        _io_write((uint8_t const *)buff, (size_t)(end - buff));
+    }
+    _io_write(END, sizeof(END) - 1U);
+
+    atomic_flag_clear_explicit(&_ctx.is_recording, memory_order_release);
+    _output_unlock(is_locked);
+    _line_release(buff);
+
+    return ((is_valid == true) && (skipped == 0)) ? LOGGER_RESULT_OK : LOGGER_RESULT_ERROR;
+}
+
+#    endif  // LOG_RECORDER_ENABLED == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_MODULES_ENABLED == 1U
+
+log_result_t log_set_module_mask(const char *name, const log_mask_t level_mask) {
+    if ((name == NULL) || (_ctx.io == NULL)) {
+        return LOGGER_RESULT_ERROR;
+    }
+
+#        if LOG_THREADSAFE_ENABLED == 1U
+    _ctx.io->lock();
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+    log_module_t *module = _module_get(name);
+    if (module != NULL) {
+        module->mask = level_mask;
+        module->is_set = true;
+        _module_update_mask();
+    }
+#        if LOG_THREADSAFE_ENABLED == 1U
+    _ctx.io->unlock();
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+
+    return (module != NULL) ? LOGGER_RESULT_OK : LOGGER_RESULT_ERROR;
+}
+
+/* -------------------------------------------------------------------------- */
+
+log_mask_t const *_log_module_mask(const char *name) {
+    /*
+        Interrupt doesn't wait for the lock, module is usually registered by thread earlier,
+        LOG calls before log_init() have no io and register it without the lock
+    */
+#        if LOG_THREADSAFE_ENABLED == 1U
+#            if LOG_ISR_QUEUE == 1U
+    bool is_locked = (_ctx.io != NULL) && (_ctx.io->is_isr() == false);
+#            else
+    bool is_locked = (_ctx.io != NULL);
+#            endif  // LOG_ISR_QUEUE == 1U
+    if (is_locked == true) {
+        _ctx.io->lock();
+    }
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+
+    log_module_t *module = _module_get(name);
+
+#        if LOG_THREADSAFE_ENABLED == 1U
+    if (is_locked == true) {
+        _ctx.io->unlock();
+    }
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+
+    /* Modules which don't fit the table follow mask of log_init() */
+    return (module != NULL) ? &module->mask : &_ctx.mask;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Finds module by name, registers it if it's new, returns NULL when the table is full */
+static log_module_t *_module_get(const char *name) {
+    for (size_t i = 0; i < _ctx.modules_count; i++) {
+        if (strcmp(_ctx.modules[i].name, name) == 0) {
+            return &_ctx.modules[i];
+        }
+    }
+    if (_ctx.modules_count == LOG_MODULES_MAX) {
+        return NULL;
+    }
+
+    log_module_t *module = &_ctx.modules[_ctx.modules_count];
+    module->name = name;
+    module->mask = _ctx.mask;
+    module->is_set = false;
+    _ctx.modules_count++;
+    return module;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Exported mask lets through everything enabled by any module, call site checks mask of its module */
+static void _module_update_mask(void) {
+    log_mask_t mask = _ctx.mask;
+    for (size_t i = 0; i < _ctx.modules_count; i++) {
+        mask |= _ctx.modules[i].mask;
+    }
+    _log_mask = mask;
+}
+
+#    endif  // LOG_MODULES_ENABLED == 1U
+
+/* -------------------------------------------------------------------------- */
+
+static void _log_format(log_mask_t level_mask, const char *format, va_list args, bool add_formating) {
+    if ((level_mask & _log_mask) == 0) {
+        _STATS_ADD(levels[_stats_level(level_mask)].filtered, 1U);
+        return;
+    }
+    _STATS_ADD(levels[_stats_level(level_mask)].emitted, 1U);
+#    if LOG_TIMESTAMP_ENABLED == 1U
+    if (atomic_load_explicit(&_ctx.is_throttled, memory_order_relaxed) == true) {
+        _throttles_report();
+    }
+#    endif  // LOG_TIMESTAMP_ENABLED == 1U
+
+#    if _LINE_ON_STACK == 1U
+    char stack_buff[_LINE_HEADROOM + _LINE_LENGTH];
+#    else
+    char *stack_buff = NULL;
+#    endif  // _LINE_ON_STACK == 1U
+    char *buff = _line_acquire(stack_buff);
+
+    log_line_t line = _line_open(buff, level_mask);
+    _log_message(&line, buff, format, args, add_formating);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Prefix, message and end of the line of any logger, the line is written and its buffer is released */
+static void _log_message(log_line_t *line, char *buff, const char *format, va_list args, bool add_formating) {
+    if (add_formating == true) {
+        _line_prefix(line);
+    }
+
+    bool is_truncated = false;
+    size_t body = line->len;
+#    if LOG_BUILTIN_PRINTF == 1U
+    /* Message is streamed to the output by parts of the line, it isn't truncated */
+    _line_vprint(line, format, args);
+#    else
+    size_t room = LOG_MAX_MESSAGE_LENGTH;
+#        if LOG_INSTANCES_ENABLED == 1U
+    /* Message of instance is limited by its buffer */
+    if (line->instance != NULL) {
+        room = line->size - line->len;
+    }
+#        endif  // LOG_INSTANCES_ENABLED == 1U
+    int len = vsnprintf(&line->data[line->len], room, format, args);
+    if (len >= (int)room) {
+        len = (int)room - 1;
+        is_truncated = true;
+        _STATS_ADD(levels[_stats_level(line->mask)].truncated, 1U);
+    }
+    _line_commit(line, len);
+#    endif  // LOG_BUILTIN_PRINTF == 1U
+    _log_finish(line, buff, body, add_formating, is_truncated);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void _log_text(const log_mask_t level_mask, const char *text, size_t size, bool add_formating) {
+    if ((level_mask & _log_mask) == 0) {
+        _STATS_ADD(levels[_stats_level(level_mask)].filtered, 1U);
+        return;
+    }
+    _STATS_ADD(levels[_stats_level(level_mask)].emitted, 1U);
+#    if LOG_TIMESTAMP_ENABLED == 1U
+    if (atomic_load_explicit(&_ctx.is_throttled, memory_order_relaxed) == true) {
+        _throttles_report();
+    }
+#    endif  // LOG_TIMESTAMP_ENABLED == 1U
+
+#    if _LINE_ON_STACK == 1U
+    char stack_buff[_LINE_HEADROOM + _LINE_LENGTH];
+#    else
+    char *stack_buff = NULL;
+#    endif  // _LINE_ON_STACK == 1U
+    char *buff = _line_acquire(stack_buff);
+
+    log_line_t line = _line_open(buff, level_mask);
+    if (add_formating == true) {
+        _line_prefix(&line);
+    }
+
+    bool is_truncated = false;
+    size_t body = line.len;
+    if (size >= LOG_MAX_MESSAGE_LENGTH) {
+        size = LOG_MAX_MESSAGE_LENGTH - 1;
+        is_truncated = true;
+        _STATS_ADD(levels[_stats_level(level_mask)].truncated, 1U);
+    }
+    _line_put(&line, text, size);
+    _log_finish(&line, buff, body, add_formating, is_truncated);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Adds the end of the line to the message which starts at 'body', writes and releases the line */
+static void _log_finish(log_line_t *line, char *buff, size_t body, bool add_formating, bool is_truncated) {
+#    if LOG_COLLAPSE_REPEATS == 1U
+    /* Message split into several writes is not compared */
+    if ((add_formating == true) && (buff == _ctx.buff) && (line->flushes == 0) &&
+        (_log_is_repeat(line->mask, &line->data[body], line->len - body) == true)) {
+        _line_release(buff);
+        return;
+    }
+#    else
+    (void)body;
+#    endif  // LOG_COLLAPSE_REPEATS == 1U
+#    if defined(LOG_ENDLINE)
+    if (add_formating == true) {
+        _line_put(line, LOG_ENDLINE, sizeof(LOG_ENDLINE) - 1);
+    }
+#    endif  // LOG_ENDLINE
+    if (is_truncated == true) {
+        _line_put(line, TRUNC_MESSAGE, sizeof(TRUNC_MESSAGE) - 1);
+    }
+    _line_flush(line);
+
+    _line_release(buff);
+}
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_COLLAPSE_REPEATS == 1U
+
+/*
+    Identical consecutive lines are counted instead of written, count is reported
+    before the next different line, text is compared only when FNV-1a hash matches
+*/
+static bool _log_is_repeat(log_mask_t level_mask, char const *body, size_t size) {
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ (uint8_t)body[i]) * 16777619UL;
+    }
+
+    if ((hash == _ctx.last_hash) && (level_mask == _ctx.last_mask) && (size == _ctx.last_size) &&
+        (size <= sizeof(_ctx.last_body)) && (memcmp(body, _ctx.last_body, size) == 0)) {
+        _ctx.repeats++;
+#        if (LOG_TIMESTAMP_DELTA == 1U) && (LOG_TIMESTAMP_ENABLED == 1U)
+        /* Stamp of skipped line is lost, the next one is full */
+        _ctx.stamp.lines = 0;
+#        endif  // (LOG_TIMESTAMP_DELTA == 1U) && (LOG_TIMESTAMP_ENABLED == 1U)
+        return true;
+    }
+    if (_ctx.repeats > 0) {
+        char buff[_LINE_HEADROOM + _PREFIX_LENGTH + 64U];
+        log_line_t line = _line_open(buff, _ctx.last_mask);
+        line.size = _PREFIX_LENGTH + 64U;
+#        if (LOG_TIMESTAMP_DELTA == 1U) && (LOG_TIMESTAMP_ENABLED == 1U)
+        /* Stamp of the current line is already taken, report is written before it */
+        _ctx.stamp.lines = 0;
+#        endif  // (LOG_TIMESTAMP_DELTA == 1U) && (LOG_TIMESTAMP_ENABLED == 1U)
+        _line_prefix(&line);
+        _line_print(&line, LOG_COLOR(LOG_COLOR_YELLOW) "Last message repeated %" PRIu32 " times" LOG_ENDLINE, _ctx.repeats);
+        _line_flush(&line);
+        _ctx.repeats = 0;
+    }
+    _ctx.last_hash = hash;
+    _ctx.last_mask = level_mask;
+    _ctx.last_size = size;
+    if (size <= sizeof(_ctx.last_body)) {
+        memcpy(_ctx.last_body, body, size);
+    }
+    return false;
+}
+
+#    endif  // LOG_COLLAPSE_REPEATS == 1U
+
+/* -------------------------------------------------------------------------- */
+
+/* Counter of call site is plain word in user code, callers of the same site may come at the same time */
+bool _log_every_n(uint32_t *count, uint32_t period) {
+    if (period == 0) {
+        return true;
+    }
+    return (atomic_fetch_add_explicit((atomic_uint *)count, 1U, memory_order_relaxed) % period) == 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool _log_once(uint32_t *done) {
+    return (atomic_load_explicit((atomic_uint *)done, memory_order_relaxed) == 0) &&
+           (atomic_exchange_explicit((atomic_uint *)done, 1U, memory_order_relaxed) == 0);
+}
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_TIMESTAMP_ENABLED == 1U
+
+/* Lets message through once per period, counts skipped ones, they are reported at level of the site */
+bool _log_every_ms(log_throttle_t **site, log_mask_t level_mask, uint32_t period_ms) {
+    if (_ctx.io == NULL) {
+        return false;
+    }
+
+    uint32_t now = (uint32_t)_ctx.io->get_uptime_ms();
+    log_throttle_t *throttle = *site;
+    if (throttle == NULL) {
+        throttle = _throttle_get(site, level_mask, period_ms);
+    }
+
+    /* Only one of callers which come at the same time takes the period */
+    uint32_t last = atomic_load_explicit(&throttle->last, memory_order_relaxed);
+    if (((now - last) < period_ms) ||
+        (atomic_compare_exchange_strong_explicit(&throttle->last, &last, now, memory_order_relaxed,
+                                                 memory_order_relaxed) == false)) {
+        if (atomic_fetch_add_explicit(&throttle->skipped, 1U, memory_order_relaxed) == 0) {
+            atomic_store_explicit(&_ctx.is_throttled, true, memory_order_relaxed);
+        }
+        return false;
+    }
+
+    uint32_t skipped = atomic_exchange_explicit(&throttle->skipped, 0, memory_order_relaxed);
+    if (skipped > 0) {
+        log_it(level_mask, LOG_COLOR(LOG_COLOR_YELLOW) "%" PRIu32 " similar messages were skipped", skipped);
+    }
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Site is registered once, the last slot is shared by sites which don't fit, interrupt doesn't wait for the lock */
+static log_throttle_t *_throttle_get(log_throttle_t **site, log_mask_t level_mask, uint32_t period_ms) {
+#        if LOG_THREADSAFE_ENABLED == 1U
+#            if LOG_ISR_QUEUE == 1U
+    bool is_locked = (_ctx.io->is_isr() == false);
+#            else
+    bool is_locked = true;
+#            endif  // LOG_ISR_QUEUE == 1U
+    if (is_locked == true) {
+        _ctx.io->lock();
+    }
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+
+    /* Another thread could register the site while this one was waiting for the lock */
+    log_throttle_t *throttle = *site;
+    if (throttle == NULL) {
+        uint32_t count = atomic_load_explicit(&_ctx.throttles_count, memory_order_relaxed);
+        if (count < LOG_THROTTLES_MAX) {
+            throttle = &_ctx.throttles[count];
+            throttle->level = level_mask;
+            throttle->period = period_ms;
+            /* The first message is let through */
+            atomic_store_explicit(
+                &throttle->last, (uint32_t)_ctx.io->get_uptime_ms() - period_ms, memory_order_relaxed);
+            atomic_store_explicit(&_ctx.throttles_count, count + 1U, memory_order_release);
+        } else {
+            throttle = &_ctx.throttles[LOG_THROTTLES_MAX - 1U];
+        }
+        *site = throttle;
+    }
+
+#        if LOG_THREADSAFE_ENABLED == 1U
+    if (is_locked == true) {
+        _ctx.io->unlock();
+    }
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+    return throttle;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/*
+    Sites which became silent after skipping messages report them once their period is over,
+    report takes the period as if message was let through
+*/
+static void _throttles_report(void) {
+    if (atomic_flag_test_and_set_explicit(&_ctx.is_reporting, memory_order_acquire) == true) {
+        return; /* Report is being written by another caller or this one is its log_it() */
+    }
+    atomic_store_explicit(&_ctx.is_throttled, false, memory_order_relaxed);
+
+    bool is_pending = false;
+    uint32_t now = (uint32_t)_ctx.io->get_uptime_ms();
+    uint32_t count = atomic_load_explicit(&_ctx.throttles_count, memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++) {
+        log_throttle_t *throttle = &_ctx.throttles[i];
+        if (atomic_load_explicit(&throttle->skipped, memory_order_relaxed) == 0) {
+            continue;
+        }
+        uint32_t last = atomic_load_explicit(&throttle->last, memory_order_relaxed);
+        if (((now - last) < throttle->period) ||
+            (atomic_compare_exchange_strong_explicit(&throttle->last, &last, now, memory_order_relaxed,
+                                                     memory_order_relaxed) == false)) {
+            is_pending = true;
+            continue;
+        }
+        uint32_t skipped = atomic_exchange_explicit(&throttle->skipped, 0, memory_order_relaxed);
+        if (skipped > 0) {
+            log_it(throttle->level, LOG_COLOR(LOG_COLOR_YELLOW) "%" PRIu32 " similar messages were skipped", skipped);
+        }
+    }
+    if (is_pending == true) {
+        atomic_store_explicit(&_ctx.is_throttled, true, memory_order_relaxed);
+    }
+
+    atomic_flag_clear_explicit(&_ctx.is_reporting, memory_order_release);
+}
+
+#    endif  // LOG_TIMESTAMP_ENABLED == 1U
+
+/* -------------------------------------------------------------------------- */
+
+void log_it(log_mask_t level_mask, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    _log_format(level_mask, format, args, true);
+    va_end(args);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void log_raw(const log_mask_t level_mask, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    _log_format(level_mask, format, args, false);
+    va_end(args);
+}
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_INSTANCES_ENABLED == 1U
+
+#        if defined(LOG_ENDLINE)
+#            define _ENDLINE_LENGTH (sizeof(LOG_ENDLINE) - 1U)
+#        else
+#            define _ENDLINE_LENGTH (0U)
+#        endif  // LOG_ENDLINE
+
+log_result_t log_instance_init(log_instance_t *instance, const log_mask_t level_mask, log_io_t const *io, char *buff,
+                               size_t size) {
+    if ((instance == NULL) || (io == NULL) || (io->write == NULL) || (buff == NULL) || (size <= _ENDLINE_LENGTH)) {
+        return LOGGER_RESULT_ERROR;
+    }
+
+#        if LOG_TIMESTAMP_ENABLED == 1U
+    if (io->get_uptime_ms == NULL) {
+        return LOGGER_RESULT_ERROR;
+    }
+#        endif  // LOG_TIMESTAMP_ENABLED == 1U
+
+#        if LOG_TIMESTAMP_TICKS == 1U
+    if (io->get_ticks == NULL) {
+        return LOGGER_RESULT_ERROR;
+    }
+#        endif  // LOG_TIMESTAMP_TICKS == 1U
+
+#        if LOG_TIMESTAMP_FORMAT > 0U
+    if (io->get_utc_time_s == NULL) {
+        return LOGGER_RESULT_ERROR;
+    }
+#        endif  // LOG_TIMESTAMP_FORMAT > 0U
+
+#        if LOG_THREADSAFE_ENABLED == 1U
+    if ((io->lock == NULL) || (io->unlock == NULL)) {
+        return LOGGER_RESULT_ERROR;
+    }
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+
+    instance->io = io;
+    instance->buff = buff;
+    instance->size = size;
+    instance->mask = level_mask;
+#        if LOG_TIMESTAMP_DELTA == 1U
+    memset(&instance->stamp, 0, sizeof(instance->stamp));
+#        endif  // LOG_TIMESTAMP_DELTA == 1U
+    return LOGGER_RESULT_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void log_instance_it(log_instance_t *instance, const log_mask_t level_mask, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    _instance_format(instance, level_mask, format, args, true);
+    va_end(args);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void log_instance_raw(log_instance_t *instance, const log_mask_t level_mask, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    _instance_format(instance, level_mask, format, args, false);
+    va_end(args);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Line goes through the same steps as line of log_it(), in the buffer of the instance under the lock of its io */
+static void _instance_format(log_instance_t *instance, log_mask_t level_mask, const char *format, va_list args,
+                             bool add_formating) {
+    if ((level_mask & instance->mask) == 0) {
+        _STATS_ADD(levels[_stats_level(level_mask)].filtered, 1U);
+        return;
+    }
+    _STATS_ADD(levels[_stats_level(level_mask)].emitted, 1U);
+
+#        if LOG_THREADSAFE_ENABLED == 1U
+    instance->io->lock();
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+    log_line_t line = _instance_open(instance, level_mask);
+    _log_message(&line, instance->buff, format, args, add_formating);
+#        if LOG_THREADSAFE_ENABLED == 1U
+    instance->io->unlock();
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Whole buffer is the line, it has no headroom, frames of LOG_DEFERRED_FORMAT aren't used by instances */
+static inline log_line_t _instance_open(log_instance_t *instance, log_mask_t level_mask) {
+    log_line_t line = {
+        .data = instance->buff, .size = instance->size, .len = 0, .mask = level_mask, .instance = instance
+    };
+    return line;
+}
+
+#    endif  // LOG_INSTANCES_ENABLED == 1U
+
+/* -------------------------------------------------------------------------- */
+
+void log_array(log_mask_t level_mask, const char *message, const void *data, size_t size) {
+    if ((level_mask & _log_mask) == 0) {
+        _STATS_ADD(levels[_stats_level(level_mask)].filtered, 1U);
+        return;
+    }
+    _STATS_ADD(levels[_stats_level(level_mask)].emitted, 1U);
+    uint8_t const *array = (uint8_t const *)data;
+
+#    if _LINE_ON_STACK == 1U
+    char stack_buff[_LINE_HEADROOM + _LINE_LENGTH];
+#    else
+    char *stack_buff = NULL;
+#    endif  // _LINE_ON_STACK == 1U
+    char *buff = _line_acquire(stack_buff);
+
+    log_line_t line = _line_open(buff, level_mask);
+    _line_prefix(&line);
+    _line_print(&line, "%s[%zu]:", message, size);
+    _line_hex(&line, array, size);
+    _line_put(&line, LOG_ENDLINE, sizeof(LOG_ENDLINE) - 1);
+    _line_flush(&line);
+
+    _line_release(buff);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void log_hexdump(log_mask_t level_mask, const char *message, const void *data, size_t size) {
+    if ((level_mask & _log_mask) == 0) {
+        _STATS_ADD(levels[_stats_level(level_mask)].filtered, 1U);
+        return;
+    }
+    _STATS_ADD(levels[_stats_level(level_mask)].emitted, 1U);
+    uint8_t const *array = (uint8_t const *)data;
+
+#    if _LINE_ON_STACK == 1U
+    char stack_buff[_LINE_HEADROOM + _LINE_LENGTH];
+#    else
+    char *stack_buff = NULL;
+#    endif  // _LINE_ON_STACK == 1U
+    char *buff = _line_acquire(stack_buff);
+
+    log_line_t line = _line_open(buff, level_mask);
+    _line_prefix(&line);
+    _line_print(&line, "%s[%zu]:", message, size);
+    _line_put(&line, LOG_ENDLINE, sizeof(LOG_ENDLINE) - 1);
+
+    /* Rows are "OOOOOOOO: XX XX ..  |ascii|", short last row is padded to keep ASCII column aligned */
+    for (size_t offset = 0; offset < size; offset += LOG_HEXDUMP_ROW_LENGTH) {
+        size_t count = size - offset;
+        if (count > LOG_HEXDUMP_ROW_LENGTH) {
+            count = LOG_HEXDUMP_ROW_LENGTH;
+        }
+
+        char text[8U + 1U + (LOG_HEXDUMP_ROW_LENGTH * 3U) + 3U + LOG_HEXDUMP_ROW_LENGTH + 1U];
+        size_t len = 0;
+        for (uint32_t shift = 28U;; shift -= 4U) {
+            text[len++] = _HEX_DIGITS[(offset >> shift) & 0x0FU];
+            if (shift == 0U) {
+                break;
+            }
+        }
+        text[len++] = ':';
+        _line_put(&line, text, len);
+        _line_hex(&line, &array[offset], count);
+
+        len = 0;
+        for (size_t i = count; i < LOG_HEXDUMP_ROW_LENGTH; i++) {
+            text[len++] = ' ';
+            text[len++] = ' ';
+            text[len++] = ' ';
+        }
+        text[len++] = ' ';
+        text[len++] = ' ';
+        text[len++] = '|';
+        for (size_t i = 0; i < count; i++) {
+            uint8_t byte = array[offset + i];
+            text[len++] = ((byte >= 0x20U) && (byte < 0x7FU)) ? (char)byte : '.';
+        }
+        text[len++] = '|';
+        _line_put(&line, text, len);
+        _line_put(&line, LOG_ENDLINE, sizeof(LOG_ENDLINE) - 1);
+    }
+    _line_flush(&line);
+
+    _line_release(buff);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void log_array_float(log_mask_t level_mask, const char *message, const float *array, size_t size) {
+    if ((level_mask & _log_mask) == 0) {
+        _STATS_ADD(levels[_stats_level(level_mask)].filtered, 1U);
+        return;
+    }
+    _STATS_ADD(levels[_stats_level(level_mask)].emitted, 1U);
+
+#    if _LINE_ON_STACK == 1U
+    char stack_buff[_LINE_HEADROOM + _LINE_LENGTH];
+#    else
+    char *stack_buff = NULL;
+#    endif  // _LINE_ON_STACK == 1U
+    char *buff = _line_acquire(stack_buff);
+
+    log_line_t line = _line_open(buff, level_mask);
+    _line_prefix(&line);
+    _line_print(&line, "%s[%zu]:", message, size);
+    for (size_t i = 0; i < size; i++) {
+        _line_put(&line, " ", 1);
+        _line_float(&line, array[i], LOG_FLOAT_DECIMALS);
+    }
+    _line_put(&line, LOG_ENDLINE, sizeof(LOG_ENDLINE) - 1);
+    _line_flush(&line);
+
+    _line_release(buff);
+}
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_ISR_QUEUE == 1U
+
+void log_flush_isr_queue(void) {
+    if ((_ctx.io == NULL) || _ctx.io->is_isr()) {
+        return;
+    }
+#        if LOG_TIMESTAMP_ENABLED == 1U
+    if (atomic_load_explicit(&_ctx.is_throttled, memory_order_relaxed) == true) {
+        _throttles_report();
+    }
+#        endif  // LOG_TIMESTAMP_ENABLED == 1U
+    /* Lines go to io as lines of threads do, under the same lock, compression keeps its state between them */
+    char *buff = _line_acquire(NULL);
+    bool is_locked = _output_lock();
+    (void)_ring_drain(&_ctx.ring, LOG_ISR_FLUSH_BUDGET);
+    _output_unlock(is_locked);
+    _line_release(buff);
+}
+
+#    endif  // LOG_ISR_QUEUE == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if _RING_ENABLED == 1U
+
+static inline uint32_t _ring_index(log_ring_t const *ring, uint32_t position) {
+    return position & (ring->size - 1U);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static inline uint32_t _record_words(log_ring_t const *ring, uint32_t position, uint32_t header) {
+    if ((header & _RECORD_PADDING) != 0) {
+        return ring->size - _ring_index(ring, position);
+    }
+    return 1U + (uint32_t)(((header & _RECORD_SIZE_MASK) + sizeof(uint32_t) - 1U) / sizeof(uint32_t));
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _ring_release(log_ring_t *ring, uint32_t tail, uint32_t words) {
+    /* Free space must be zeroed, so reserved but not yet written record isn't taken as committed */
+    uint32_t index = _ring_index(ring, tail);
+    uint32_t count = ((index + words) > ring->size) ? (ring->size - index) : words;
+    memset((void *)&ring->words[index], 0, count * sizeof(uint32_t));
+    memset((void *)&ring->words[0], 0, (words - count) * sizeof(uint32_t));
+    atomic_store_explicit(&ring->tail, tail + words, memory_order_release);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Takes ownership of committed record at tail, owner is the only one who moves tail */
+static bool _ring_claim(log_ring_t *ring, uint32_t tail, uint32_t *header) {
+    atomic_uint *slot = &ring->words[_ring_index(ring, tail)];
+    uint32_t value = atomic_load_explicit(slot, memory_order_acquire);
+    if (((value & _RECORD_COMMITTED) == 0) || (atomic_load_explicit(&ring->tail, memory_order_acquire) != tail)) {
+        return false;
+    }
+
+    uint32_t claimed = (value & (uint32_t)~_RECORD_COMMITTED) | _RECORD_CLAIMED;
+    if (atomic_compare_exchange_strong_explicit(slot, &value, claimed, memory_order_acq_rel, memory_order_relaxed) ==
+        false) {
+        return false;
+    }
+    if (atomic_load_explicit(&ring->tail, memory_order_acquire) != tail) {
+        /* Tail was moved by another owner, slot isn't a tail record anymore, give it back */
+        (void)atomic_compare_exchange_strong_explicit(
+            slot, &claimed, value, memory_order_acq_rel, memory_order_relaxed);
+        return false;
+    }
+
+    *header = value;
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static bool _ring_push(log_ring_t *ring, log_mask_t level_mask, uint8_t const *data, size_t size) {
+#        if LOG_BACKPRESSURE_ENABLED == 0U
+    (void)level_mask;
+#        endif  // LOG_BACKPRESSURE_ENABLED == 0U
+    uint32_t words = 1U + (uint32_t)((size + sizeof(uint32_t) - 1U) / sizeof(uint32_t));
+    if ((size == 0) || (size > _RECORD_SIZE_MASK) || (words > ring->size)) {
+        atomic_fetch_add_explicit(&ring->dropped, 1U, memory_order_relaxed);
+        _STATS_ADD(dropped, 1U);
+        return false;
+    }
+
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t padding = 0;
+    for (;;) {
+        uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        uint32_t index = _ring_index(ring, head);
+        padding = ((index + words) > ring->size) ? (ring->size - index) : 0U;
+
+#        if LOG_BACKPRESSURE_ENABLED == 1U
+        /* Reserved room is kept for LOG_BACKPRESSURE_MASK levels, other lines are shed before eviction */
+        if (((level_mask & (LOG_BACKPRESSURE_MASK)) == 0) && ((head + padding + words - tail) > ring->limit)) {
+            atomic_fetch_add_explicit(&ring->shed[_stats_level(level_mask)], 1U, memory_order_relaxed);
+            _STATS_ADD(dropped, 1U);
+            return false;
+        }
+#        endif  // LOG_BACKPRESSURE_ENABLED == 1U
+
+        if ((head + padding + words - tail) > ring->size) {
+            uint32_t header = 0;
+#        if LOG_BACKPRESSURE_ENABLED == 1U
+            /* Only lines of reserved levels get here, they evict other lines but not each other */
+            header = atomic_load_explicit(&ring->words[_ring_index(ring, tail)], memory_order_acquire);
+            bool is_evictable = (ring->is_overwrite == true) && ((header & _RECORD_RESERVED) == 0);
+#        else
+            bool is_evictable = ring->is_overwrite;
+#        endif  // LOG_BACKPRESSURE_ENABLED == 1U
+            if ((is_evictable == true) && (_ring_claim(ring, tail, &header) == true)) {
+                _ring_release(ring, tail, _record_words(ring, tail, header));
+                if ((header & _RECORD_PADDING) == 0) {
+                    atomic_fetch_add_explicit(&ring->dropped, 1U, memory_order_relaxed);
+                    _STATS_ADD(dropped, 1U);
+                }
+                head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+                continue;
+            }
+            if (atomic_load_explicit(&ring->tail, memory_order_acquire) != tail) {
+                head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+                continue;
+            }
+            atomic_fetch_add_explicit(&ring->dropped, 1U, memory_order_relaxed);
+            _STATS_ADD(dropped, 1U);
+            return false;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(
+                &ring->head, &head, head + padding + words, memory_order_relaxed, memory_order_relaxed) == true) {
+            break;
+        }
+    }
+
+    if (padding > 0) {
+        atomic_store_explicit(
+            &ring->words[_ring_index(ring, head)], _RECORD_COMMITTED | _RECORD_PADDING, memory_order_release);
+    }
+
+    uint32_t index = _ring_index(ring, head + padding);
+    memcpy((void *)&ring->words[index + 1U], data, size);
+    uint32_t header = _RECORD_COMMITTED | (uint32_t)size;
+#        if LOG_BACKPRESSURE_ENABLED == 1U
+    if ((level_mask & (LOG_BACKPRESSURE_MASK)) != 0) {
+        header |= _RECORD_RESERVED;
+    }
+#        endif  // LOG_BACKPRESSURE_ENABLED == 1U
+    atomic_store_explicit(&ring->words[index], header, memory_order_release);
+
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Writes up to 'budget' messages, several committed records in a row are written by one writev */
+static size_t _ring_drain(log_ring_t *ring, size_t budget) {
+    size_t count = 0;
+    while (count < budget) {
+        uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (tail == atomic_load_explicit(&ring->head, memory_order_acquire)) {
+            break;
+        }
+
+        uint32_t header = 0;
+        if (_ring_claim(ring, tail, &header) == false) {
+            if (atomic_load_explicit(&ring->tail, memory_order_acquire) != tail) {
+                continue; /* Record was overwritten */
+            }
+            break; /* Record is not committed yet */
+        }
+
+        /* Following committed records can't be evicted while tail is owned, send them together */
+        uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        uint32_t position = tail;
+        log_iovec_t iov[8];
+        size_t iov_count = 0;
+        for (;;) {
+            if ((header & _RECORD_PADDING) == 0) {
+                iov[iov_count].data = (uint8_t const *)&ring->words[_ring_index(ring, position) + 1U];
+                iov[iov_count].size = header & _RECORD_SIZE_MASK;
+                iov_count++;
+            }
+            position += _record_words(ring, position, header);
+            if ((position == head) || (iov_count == (sizeof(iov) / sizeof(iov[0]))) ||
+                ((count + iov_count) == budget)) {
+                break;
+            }
+            header = atomic_load_explicit(&ring->words[_ring_index(ring, position)], memory_order_acquire);
+            if ((header & _RECORD_COMMITTED) == 0) {
+                break;
+            }
+        }
+
+        _log_writev(ring->write, iov, iov_count);
+        count += iov_count;
+        _ring_release(ring, tail, position - tail);
+    }
+
+    uint32_t dropped = atomic_exchange_explicit(&ring->dropped, 0, memory_order_relaxed);
+    if (dropped > 0) {
+        char buff[_LINE_HEADROOM + 64U];
+        log_line_t line = _line_open(buff, LOG_MASK_ALL);
+        line.size = 64U;
+        const char *color = (ring->is_color == true) ? LOG_COLOR(LOG_COLOR_RED) : "";
+        _line_print(&line, "%s%" PRIu32 " messages were dropped" LOG_ENDLINE, color, dropped);
+        log_iovec_t iov = _line_finish(&line);
+        _log_writev(ring->write, &iov, 1);
+    }
+#        if LOG_BACKPRESSURE_ENABLED == 1U
+    _ring_report_shed(ring);
+#        endif  // LOG_BACKPRESSURE_ENABLED == 1U
+
+    return count;
+}
+
+/* -------------------------------------------------------------------------- */
+
+#        if LOG_BACKPRESSURE_ENABLED == 1U
+
+/* Shed lines are reported once the queue is below the limit, so the report doesn't take reserved room */
+static void _ring_report_shed(log_ring_t *ring) {
+    static const char *const _NAMES[LOG_STATS_LEVELS] = { "info",  "warning", "error", "debug",
+                                                          "raw",   "user1",   "user2", "user3" };
+
+    uint32_t used = atomic_load_explicit(&ring->head, memory_order_acquire) -
+                    atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (used > ring->limit) {
+        return;
+    }
+
+    char buff[_LINE_HEADROOM + 192U];
+    log_line_t line = _line_open(buff, LOG_MASK_ALL);
+    line.size = 192U;
+    for (uint32_t i = 0; i < LOG_STATS_LEVELS; i++) {
+        /* Load is much cheaper than exchange, counters are usually zero */
+        if (atomic_load_explicit(&ring->shed[i], memory_order_relaxed) == 0) {
+            continue;
+        }
+        uint32_t shed = atomic_exchange_explicit(&ring->shed[i], 0, memory_order_relaxed);
+        if (line.len == 0) {
+            const char *color = (ring->is_color == true) ? LOG_COLOR(LOG_COLOR_YELLOW) : "";
+            _line_print(&line, "%sShed by backpressure:", color);
+        }
+        _line_print(&line, " %s %" PRIu32, _NAMES[i], shed);
+    }
+    if (line.len == 0) {
+        return;
+    }
+    _line_put(&line, LOG_ENDLINE, sizeof(LOG_ENDLINE) - 1U);
+    log_iovec_t iov = _line_finish(&line);
+    _log_writev(ring->write, &iov, 1);
+}
+
+#        endif  // LOG_BACKPRESSURE_ENABLED == 1U
+
+#    endif  // _RING_ENABLED == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if (LOG_ASYNC_ENABLED == 1U) || (_SINK_QUEUE_ENABLED == 1U)
+
+size_t log_process(void) {
+    if (_ctx.io == NULL) {
+        return 0;
+    }
+#        if LOG_TIMESTAMP_ENABLED == 1U
+    if (atomic_load_explicit(&_ctx.is_throttled, memory_order_relaxed) == true) {
+        _throttles_report();
+    }
+#        endif  // LOG_TIMESTAMP_ENABLED == 1U
+
+    size_t count = 0;
+#        if LOG_ASYNC_ENABLED == 1U
+#            if LOG_IO_FLUSH == 1U
+    /* Flag is taken first, so line which has set it is already in the ring */
+    bool is_flush = atomic_exchange_explicit(&_ctx.is_flush_pending, false, memory_order_acquire);
+#            endif  // LOG_IO_FLUSH == 1U
+    count += _ring_drain(&_ctx.ring, SIZE_MAX);
+#            if LOG_IO_FLUSH == 1U
+    if (is_flush == true) {
+        _ctx.io->flush();
+    }
+#            endif  // LOG_IO_FLUSH == 1U
+#        endif  // LOG_ASYNC_ENABLED == 1U
+#        if _SINK_QUEUE_ENABLED == 1U
+    for (size_t i = 0; i < _ctx.sinks_count; i++) {
+        if (_ctx.sinks[i].sink.is_queued == true) {
+            count += _ring_drain(&_ctx.sinks[i].queue, SIZE_MAX);
+        }
+    }
+#        endif  // _SINK_QUEUE_ENABLED == 1U
+    return count;
+}
+
+#    endif  // (LOG_ASYNC_ENABLED == 1U) || (_SINK_QUEUE_ENABLED == 1U)
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_DEFERRED_FORMAT == 1U
+
+/* Provided by linker for "log_fmt" section, weak to link without any LOG call */
+extern const char __start_log_fmt[] __attribute__((weak));
+extern const char __stop_log_fmt[] __attribute__((weak));
+
+void log_deferred(const log_mask_t level_mask, const char *format, ...) {
+    if ((level_mask & _log_mask) == 0) {
+        _STATS_ADD(levels[_stats_level(level_mask)].filtered, 1U);
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+
+    bool is_encoded = false;
+    if (((uintptr_t)format >= (uintptr_t)__start_log_fmt) && ((uintptr_t)format < (uintptr_t)__stop_log_fmt)) {
+#        if _LINE_ON_STACK == 1U
+        char stack_buff[_LINE_HEADROOM + _LINE_LENGTH];
+#        else
+        char *stack_buff = NULL;
+#        endif  // _LINE_ON_STACK == 1U
+        char *buff = _line_acquire(stack_buff);
+        is_encoded = _log_encode(buff, level_mask, format, args);
+        _line_release(buff);
+    }
+
+    if (is_encoded == true) {
+        _STATS_ADD(levels[_stats_level(level_mask)].emitted, 1U);
+    } else {
+        /* Unknown format or too long arguments, send it as text, it's counted there */
+        va_end(args);
+        va_start(args, format);
+        _log_format(level_mask, format, args, true);
+    }
+    va_end(args);
+}
+
+#    endif  // LOG_DEFERRED_FORMAT == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_DEFERRED_DECODER == 1U
+
+#        if LOG_TIMESTAMP_ENABLED == 1U
+static log_timestamp_t _decoded_stamp;
+#        endif  // LOG_TIMESTAMP_ENABLED == 1U
+#        if LOG_TIMESTAMP_FORMAT > 0U
+static time_t _decoded_utc_time_s;
+#        endif  // LOG_TIMESTAMP_FORMAT > 0U
+
+static const uint8_t *_get_varint(const uint8_t *src, uint8_t const *end, uint64_t *value) {
+    uint64_t result = 0;
+    for (uint32_t shift = 0; (src < end) && (shift < 64U); shift += 7U) {
+        uint8_t byte = *src;
+        src++;
+        result |= (uint64_t)(byte & 0x7FU) << shift;
+        if ((byte & 0x80U) == 0) {
+            *value = result;
+            return src;
+        }
+    }
+    return NULL;
+}
+
+static inline int64_t _unzigzag(uint64_t value) {
+    return ((value & 1U) != 0) ? -(int64_t)(value >> 1) - 1 : (int64_t)(value >> 1);
+}
+
+#        if LOG_TIMESTAMP_ENABLED == 1U
+static log_timestamp_t _get_decoded_stamp(void) {
+    return _decoded_stamp;
+}
+#        endif  // LOG_TIMESTAMP_ENABLED == 1U
+
+#        if LOG_TIMESTAMP_FORMAT > 0U
+static time_t _get_decoded_utc_time_s(void) {
+    return _decoded_utc_time_s;
+}
+#        endif  // LOG_TIMESTAMP_FORMAT > 0U
+
+static void _decode_message(const char *formats, size_t formats_size, const uint8_t *src, uint8_t const *end) {
+    uint64_t value = 0;
+    if (src >= end) {
+        return;
+    }
+    log_mask_t level_mask = (log_mask_t)*src;
+    src++;
+
+#        if LOG_TIMESTAMP_ENABLED == 1U
+    src = _get_varint(src, end, &value);
+    _decoded_stamp = (log_timestamp_t)value;
+#            if LOG_TIMESTAMP_FORMAT > 0U
+    src = (src != NULL) ? _get_varint(src, end, &value) : NULL;
+    _decoded_utc_time_s = (time_t)_unzigzag(value);
+#            endif  // LOG_TIMESTAMP_FORMAT > 0U
+#        endif      // LOG_TIMESTAMP_ENABLED == 1U
+
+    src = (src != NULL) ? _get_varint(src, end, &value) : NULL;
+    if ((src == NULL) || (value >= formats_size) || (memchr(&formats[value], '\0', formats_size - value) == NULL)) {
+        return;
+    }
+
+    char body[LOG_MAX_MESSAGE_LENGTH + 1U];
+    char text[LOG_MAX_MESSAGE_LENGTH];
+    size_t len = 0;
+    const char *format = &formats[value];
+    while ((*format != '\0') && (src != NULL) && (len < (sizeof(body) - 1U))) {
+        if (*format != '%') {
+            body[len] = *format;
+            len++;
+            format++;
+            continue;
+        }
+
+        /* Rebuild specification with values of '*' and length modifier suitable for decoded value */
+        _format_spec_t spec;
+        const char *next = _parse_spec(format + 1, &spec);
+        char spec_text[32] = { '%' };
+        size_t spec_len = 1;
+        bool is_precision = false;
+        for (const char *c = format + 1; (*c != spec.conversion) && (spec_len < (sizeof(spec_text) - 24U)); c++) {
+            if (*c == '*') {
+                src = _get_varint(src, end, &value);
+                if (src == NULL) {
+                    break;
+                }
+                /* Corrupted width would pad far beyond the message */
+                int64_t arg = _unzigzag(value);
+                if ((arg > (int64_t)LOG_MAX_MESSAGE_LENGTH) || (arg < -(int64_t)LOG_MAX_MESSAGE_LENGTH)) {
+                    arg = (arg < 0) ? -(int64_t)LOG_MAX_MESSAGE_LENGTH : (int64_t)LOG_MAX_MESSAGE_LENGTH;
+                }
+                if ((is_precision == true) && (arg < 0)) {
+                    spec_len--; /* Negative precision is taken as if the precision were omitted */
+                } else {
+                    spec_len += (size_t)snprintf(&spec_text[spec_len], sizeof(spec_text) - spec_len, "%d", (int)arg);
+                }
+            } else if (strchr("hljztL", *c) == NULL) {
+                is_precision = is_precision || (*c == '.');
+                spec_text[spec_len] = *c;
+                spec_len++;
+            }
+        }
+        format = next;
+        if ((spec.conversion == '\0') || (src == NULL)) {
+            break;
+        }
+
+        int ret = 0;
+        size_t room = sizeof(body) - len;
+        switch (spec.conversion) {
+            case '%':
+                ret = snprintf(&body[len], room, "%%");
+                break;
+            case 'd':
+            case 'i':
+                src = _get_varint(src, end, &value);
+                if (src == NULL) {
+                    break;
+                }
+                (void)snprintf(&spec_text[spec_len], sizeof(spec_text) - spec_len, "ll%c", spec.conversion);
+                ret = snprintf(&body[len], room, spec_text, (long long)_unzigzag(value));
+                break;
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                src = _get_varint(src, end, &value);
+                if (src == NULL) {
+                    break;
+                }
+                (void)snprintf(&spec_text[spec_len], sizeof(spec_text) - spec_len, "ll%c", spec.conversion);
+                ret = snprintf(&body[len], room, spec_text, (unsigned long long)value);
+                break;
+            case 'c':
+                src = _get_varint(src, end, &value);
+                if (src == NULL) {
+                    break;
+                }
+                spec_text[spec_len] = spec.conversion;
+                ret = snprintf(&body[len], room, spec_text, (int)value);
+                break;
+            case 'p':
+                src = _get_varint(src, end, &value);
+                if (src == NULL) {
+                    break;
+                }
+                spec_text[spec_len] = spec.conversion;
+                ret = snprintf(&body[len], room, spec_text, (void *)(uintptr_t)value);
+                break;
+            case 's':
+                src = _get_varint(src, end, &value);
+                if ((src == NULL) || (value >= sizeof(text)) || (value > (uint64_t)(end - src))) {
+                    src = NULL;
+                    break;
+                }
+                memcpy(text, src, (size_t)value);
+                text[value] = '\0';
+                src += value;
+                spec_text[spec_len] = spec.conversion;
+                ret = snprintf(&body[len], room, spec_text, text);
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A': {
+                if ((end - src) < 8) {
+                    src = NULL;
+                    break;
+                }
+                uint64_t bits = 0;
+                for (uint32_t i = 0; i < 8U; i++) {
+                    bits |= (uint64_t)src[i] << (8U * i);
+                }
+                src += 8;
+                double real = 0;
+                memcpy(&real, &bits, sizeof(real));
+                spec_text[spec_len] = spec.conversion;
+                ret = snprintf(&body[len], room, spec_text, real);
+                break;
+            }
+            case 'n':
+                break;
+            default:
+                src = NULL;
+                break;
+        }
+        if (ret > 0) {
+            len += ((size_t)ret < room) ? (size_t)ret : (room - 1U);
+        }
+    }
+    /* Truncated or corrupted arguments, values read so far can't be trusted */
+    if (src == NULL) {
+        return;
+    }
+    body[len] = '\0';
+
+    /* Print message by the same code as target does, but with decoded timestamps */
+    log_io_t io = *_ctx.io;
+#        if LOG_TIMESTAMP_ENABLED == 1U
+    io.get_uptime_ms = _get_decoded_stamp;
+#        endif  // LOG_TIMESTAMP_ENABLED == 1U
+#        if LOG_TIMESTAMP_TICKS == 1U
+    io.get_ticks = _get_decoded_stamp;
+#        endif  // LOG_TIMESTAMP_TICKS == 1U
+#        if LOG_TIMESTAMP_FORMAT > 0U
+    io.get_utc_time_s = _get_decoded_utc_time_s;
+#        endif  // LOG_TIMESTAMP_FORMAT > 0U
+    log_io_t const *target_io = _ctx.io;
+    _ctx.io = &io;
+    log_it(level_mask, "%s", body);
+    _ctx.io = target_io;
+}
+
+size_t log_deferred_decode(const char *formats, size_t formats_size, const uint8_t *data, size_t size) {
+    const uint8_t *src = data;
+    uint8_t const *end = &data[size];
+
+    while ((src < end) && (_ctx.io != NULL)) {
+        uint8_t type = *src & 0x0FU;
+        if (((*src & 0xF0U) != _FRAME_MAGIC) || ((type != _FRAME_TEXT) && (type != _FRAME_MESSAGE))) {
+            src++; /* Garbage, look for the next frame */
+            continue;
+        }
+
+        uint64_t payload_size = 0;
+        const uint8_t *payload = _get_varint(src + 1, end, &payload_size);
+        if (payload == NULL) {
+            if ((end - src) > (ptrdiff_t)(1U + _VARINT_MAX)) {
+                src++;
+                continue;
+            }
+            break; /* Incomplete header */
+        }
+        if (payload_size > _FRAME_MAX_PAYLOAD) {
+            src++;
+            continue;
+        }
+        if ((uint64_t)(end - payload) < payload_size) {
+            break; /* Incomplete payload */
+        }
+
+        if (type == _FRAME_TEXT) {
+            _ctx.io->write(payload, (size_t)payload_size);
+        } else {
+            _decode_message(formats, formats_size, payload, &payload[payload_size]);
+        }
+        src = &payload[payload_size];
+    }
+
+    return (size_t)(src - data);
+}
+
+#    endif  // LOG_DEFERRED_DECODER == 1U
+
+/* -------------------------------------------------------------------------- */
+
+/* Returns false when line is dropped by the queue, so it isn't counted as written */
+static inline bool _log_write(log_mask_t level_mask, uint8_t const *data, size_t size) {
+#    if LOG_ASYNC_ENABLED == 1U
+    return _ring_push(&_ctx.ring, level_mask, data, size);
+#    endif  // LOG_ASYNC_ENABLED == 1U
+
+#    if LOG_ISR_QUEUE == 1U
+    if (_ctx.io->is_isr()) {
+        return _ring_push(&_ctx.ring, level_mask, data, size);
+    }
+    (void)_ring_drain(&_ctx.ring, LOG_ISR_FLUSH_BUDGET);
+#    endif  // LOG_ISR_QUEUE == 1U
+
+    (void)level_mask;
+    _io_write(data, size);
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_IO_FLUSH == 1U
+
+/* Line of LOG_IO_FLUSH_MASK is pushed out of io buffers, interrupts leave it for the next line */
+static inline void _io_flush(log_mask_t level_mask) {
+    if ((level_mask & (LOG_IO_FLUSH_MASK)) == 0) {
+        return;
+    }
+#        if LOG_ASYNC_ENABLED == 1U
+    atomic_store_explicit(&_ctx.is_flush_pending, true, memory_order_release);
+#        else
+#            if LOG_ISR_QUEUE == 1U
+    if (_ctx.io->is_isr()) {
+        return;
+    }
+#            endif  // LOG_ISR_QUEUE == 1U
+    _ctx.io->flush();
+#        endif  // LOG_ASYNC_ENABLED == 1U
+}
+
+#    endif  // LOG_IO_FLUSH == 1U
+
+/* -------------------------------------------------------------------------- */
+
+/* The last stage before io->write, output is compressed here */
+static void _io_write(uint8_t const *data, size_t size) {
+    uint32_t start = _STATS_CLOCK();
+#    if LOG_COMPRESS_ENABLED == 1U
+    log_lz_t *lz = &_ctx.lz;
+    while (size > 0) {
+        size_t chunk = (size < _BLOCK_INPUT) ? size : _BLOCK_INPUT;
+        uint8_t header = _BLOCK_MAGIC;
+        if (lz->since_reset >= LOG_COMPRESS_SYNC_INTERVAL) {
+            _lz_reset(lz);
+            lz->since_reset = 0;
+            header |= _BLOCK_RESET;
+        }
+
+        uint8_t *payload = &lz->block[_BLOCK_HEADER];
+        size_t len = _lz_compress(lz, data, chunk, payload);
+        if (len >= chunk) {
+            memcpy(payload, data, chunk); /* Window is the same, decoder puts stored bytes to it too */
+            len = chunk;
+            header |= _BLOCK_STORED;
+        }
+        lz->block[0] = header;
+        lz->block[1] = (uint8_t)(len & 0xFFU);
+        lz->block[2] = (uint8_t)(len >> 8);
+        _io_send(lz->block, _BLOCK_HEADER + len);
+
+        lz->since_reset += (uint32_t)chunk;
+        data += chunk;
+        size -= chunk;
+    }
+#    else
+    _io_send(data, size);
+#    endif  // LOG_COMPRESS_ENABLED == 1U
+    _STATS_ADD(write_time, _STATS_CLOCK() - start);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static inline void _io_send(uint8_t const *data, size_t size) {
+#    if LOG_IO_WRITE_ASYNC == 1U
+    _tx_write(data, size);
+#    else
+    _ctx.io->write(data, size);
+#    endif  // LOG_IO_WRITE_ASYNC == 1U
+}
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_IO_WRITE_ASYNC == 1U
+
+void log_write_complete(void) {
+    log_tx_t *tx = &_ctx.tx;
+    atomic_fetch_add_explicit(&tx->sent, 1U, memory_order_seq_cst);
+    atomic_store_explicit(&tx->is_busy, false, memory_order_seq_cst);
+    _tx_kick(tx);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Called under the lock, it waits only for the owner change or for a buffer by io->wait with LOG_ASYNC_BLOCK */
+static void _tx_write(uint8_t const *data, size_t size) {
+    log_tx_t *tx = &_ctx.tx;
+    bool is_owned = false;
+    while (atomic_compare_exchange_weak_explicit(
+               &tx->is_owned, &is_owned, true, memory_order_seq_cst, memory_order_relaxed) == false) {
+        is_owned = false; /* log_write_complete() takes the active buffer */
+    }
+
+    if (tx->dropped > 0) {
+        char notice[64];
+        uint32_t dropped = tx->dropped;
+        tx->dropped = 0;
+        int len = snprintf(
+            notice, sizeof(notice), LOG_COLOR(LOG_COLOR_RED) "%" PRIu32 " messages were dropped" LOG_ENDLINE, dropped);
+        if ((len > 0) && (_tx_put(tx, (uint8_t const *)notice, (size_t)len) == true)) {
+            tx->noticed += dropped;
+        } else {
+            tx->dropped += dropped;
+        }
+    }
+    if (_tx_put(tx, data, size) == true) {
+        tx->lines++;
+    } else {
+        tx->dropped++;
+        _STATS_ADD(dropped, 1U);
+    }
+
+    atomic_store_explicit(&tx->is_owned, false, memory_order_seq_cst);
+    _tx_kick(tx);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Copies bytes to the active buffer, returns false when there is no buffer for them */
+static bool _tx_put(log_tx_t *tx, uint8_t const *data, size_t size) {
+    size_t len = atomic_load_explicit(&tx->len, memory_order_relaxed);
+    /* Line which fits into one buffer isn't split */
+    if ((len > 0) && ((len + size) > LOG_IO_BUFFER_SIZE) && (size <= LOG_IO_BUFFER_SIZE) &&
+        (_tx_next(tx) == false)) {
+        return false;
+    }
+
+    while (size > 0) {
+        len = atomic_load_explicit(&tx->len, memory_order_relaxed);
+        if (len == LOG_IO_BUFFER_SIZE) {
+            if (_tx_next(tx) == false) {
+                return false;
+            }
+            len = 0;
+        }
+        size_t count = LOG_IO_BUFFER_SIZE - len;
+        if (count > size) {
+            count = size;
+        }
+        uint32_t fill = atomic_load_explicit(&tx->fill, memory_order_relaxed);
+        memcpy(&tx->data[fill & (LOG_IO_BUFFERS - 1U)][len], data, count);
+        atomic_store_explicit(&tx->len, len + count, memory_order_seq_cst);
+        data += count;
+        size -= count;
+    }
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Passes the active buffer to the sender and takes the next one, LOG_IO_BUFFER_POLICY is applied when all are busy */
+static bool _tx_next(log_tx_t *tx) {
+    uint32_t fill = atomic_load_explicit(&tx->fill, memory_order_relaxed);
+    while ((fill + 1U - atomic_load_explicit(&tx->sent, memory_order_acquire)) >= LOG_IO_BUFFERS) {
+#        if LOG_IO_BUFFER_POLICY == LOG_ASYNC_BLOCK
+        _ctx.io->wait();
+#        elif LOG_IO_BUFFER_POLICY == LOG_ASYNC_OVERWRITE
+        /* Lines which wait in the active buffer are dropped, it's filled again */
+        tx->dropped += tx->lines + tx->noticed;
+        _STATS_ADD(dropped, tx->lines);
+        tx->lines = 0;
+        tx->noticed = 0;
+        atomic_store_explicit(&tx->len, 0, memory_order_seq_cst);
+        return true;
+#        else
+        return false;
+#        endif  // LOG_IO_BUFFER_POLICY
+    }
+
+    tx->sizes[fill & (LOG_IO_BUFFERS - 1U)] = atomic_load_explicit(&tx->len, memory_order_relaxed);
+    tx->lines = 0;
+    tx->noticed = 0;
+    atomic_store_explicit(&tx->len, 0, memory_order_seq_cst);
+    atomic_store_explicit(&tx->fill, fill + 1U, memory_order_seq_cst);
+    _tx_kick(tx);
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/*
+    Starts transfer of the next buffer unless one is in flight, it's called by LOG caller
+    and by log_write_complete(). Active buffer is taken when nothing else is left to send
+    and its owner doesn't fill it, otherwise the owner calls it again when it's done
+*/
+static void _tx_kick(log_tx_t *tx) {
+    for (;;) {
+        if (atomic_exchange_explicit(&tx->is_busy, true, memory_order_seq_cst) == true) {
+            return;
+        }
+
+        uint32_t sent = atomic_load_explicit(&tx->sent, memory_order_seq_cst);
+        bool is_owned = false;
+        if ((sent == atomic_load_explicit(&tx->fill, memory_order_seq_cst)) &&
+            (atomic_compare_exchange_strong_explicit(
+                 &tx->is_owned, &is_owned, true, memory_order_seq_cst, memory_order_relaxed) == true)) {
+            size_t len = atomic_load_explicit(&tx->len, memory_order_relaxed);
+            if (len > 0) {
+                tx->sizes[sent & (LOG_IO_BUFFERS - 1U)] = len;
+                tx->lines = 0;
+                tx->noticed = 0;
+                atomic_store_explicit(&tx->len, 0, memory_order_relaxed);
+                atomic_store_explicit(&tx->fill, sent + 1U, memory_order_seq_cst);
+            }
+            atomic_store_explicit(&tx->is_owned, false, memory_order_seq_cst);
+        }
+
+        uint32_t fill = atomic_load_explicit(&tx->fill, memory_order_seq_cst);
+        if (sent != fill) {
+            uint32_t index = sent & (LOG_IO_BUFFERS - 1U);
+            _ctx.io->write_async(tx->data[index], tx->sizes[index]);
+            return;
+        }
+
+        atomic_store_explicit(&tx->is_busy, false, memory_order_seq_cst);
+        /* Buffer could be passed or released after the check, its owner saw the transfer busy */
+        if ((atomic_load_explicit(&tx->fill, memory_order_seq_cst) == sent) &&
+            ((atomic_load_explicit(&tx->is_owned, memory_order_seq_cst) == true) ||
+             (atomic_load_explicit(&tx->len, memory_order_seq_cst) == 0))) {
+            return;
+        }
+    }
+}
+
+#    endif  // LOG_IO_WRITE_ASYNC == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if (LOG_COMPRESS_ENABLED == 1U) || (LOG_COMPRESS_DECODER == 1U)
+
+/* Window starts with the dictionary at its end, so the first lines already have matches */
+static void _lz_reset(log_lz_t *lz) {
+    static const char DICTIONARY[] = LOG_COMPRESS_DICTIONARY;
+    char const *dictionary = DICTIONARY;
+    size_t size = sizeof(DICTIONARY) - 1U;
+    if (size > LOG_COMPRESS_WINDOW) {
+        dictionary += size - LOG_COMPRESS_WINDOW;
+        size = LOG_COMPRESS_WINDOW;
+    }
+
+    memset(lz->window, 0, sizeof(lz->window));
+    memcpy(&lz->window[LOG_COMPRESS_WINDOW - size], dictionary, size);
+    lz->position = LOG_COMPRESS_WINDOW;
+
+#        if LOG_COMPRESS_ENABLED == 1U
+    memset(lz->head, 0, sizeof(lz->head));
+    memset(lz->prev, 0, sizeof(lz->prev));
+    for (uint32_t i = LOG_COMPRESS_WINDOW - (uint32_t)size; (i + 2U) < LOG_COMPRESS_WINDOW; i++) {
+        uint32_t hash = _lz_hash(&lz->window[i]);
+        lz->prev[i] = lz->head[hash];
+        lz->head[hash] = (uint16_t)i;
+    }
+#        endif  // LOG_COMPRESS_ENABLED == 1U
+}
+
+#    endif  // (LOG_COMPRESS_ENABLED == 1U) || (LOG_COMPRESS_DECODER == 1U)
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_COMPRESS_ENABLED == 1U
+
+static inline uint32_t _lz_hash(uint8_t const *data) {
+    uint32_t hash = ((uint32_t)data[0] << 16) | ((uint32_t)data[1] << 8) | data[2];
+    return ((hash * 2654435761UL) >> 16) & (_LZ_HASH_SIZE - 1U);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Byte at 'distance' before i + n, match may overlap bytes which are not in the window yet */
+static inline uint8_t _lz_byte(log_lz_t const *lz, uint8_t const *data, size_t i, uint32_t distance, size_t n) {
+    if (n < distance) {
+        return lz->window[(lz->position - distance + n) & _LZ_MASK];
+    }
+    return data[i + n - distance];
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Greedy LZSS, returns payload length, it can be up to size + size / 8 + 1 */
+static size_t _lz_compress(log_lz_t *lz, uint8_t const *data, size_t size, uint8_t *dst) {
+    size_t len = 0;
+    uint8_t *flags = NULL;
+    uint32_t bit = 8U;
+    size_t i = 0;
+    while (i < size) {
+        if (bit == 8U) {
+            flags = &dst[len++];
+            *flags = 0;
+            bit = 0;
+        }
+
+        size_t best_len = 0;
+        uint32_t best_distance = 0;
+        if ((i + _LZ_MIN_MATCH) <= size) {
+            size_t limit = ((size - i) < _LZ_MAX_MATCH) ? (size - i) : _LZ_MAX_MATCH;
+            uint16_t candidate = lz->head[_lz_hash(&data[i])];
+            uint32_t last_distance = 0;
+            for (uint32_t depth = 0; depth < _LZ_CHAIN_DEPTH; depth++) {
+                uint32_t distance = (uint16_t)((uint16_t)lz->position - candidate);
+                if ((distance <= last_distance) || (distance > LOG_COMPRESS_WINDOW)) {
+                    break; /* Chain went to overwritten part of the window */
+                }
+                last_distance = distance;
+
+                size_t n = 0;
+                while ((n < limit) && (_lz_byte(lz, data, i, distance, n) == data[i + n])) {
+                    n++;
+                }
+                if (n > best_len) {
+                    best_len = n;
+                    best_distance = distance;
+                    if (n == limit) {
+                        break;
+                    }
+                }
+                candidate = lz->prev[candidate & _LZ_MASK];
+            }
+        }
+
+        if (best_len >= _LZ_MIN_MATCH) {
+            uint32_t token = (best_distance - 1U) | ((uint32_t)(best_len - _LZ_MIN_MATCH) << _LZ_DISTANCE_BITS);
+            *flags |= (uint8_t)(1U << bit);
+            dst[len++] = (uint8_t)(token & 0xFFU);
+            dst[len++] = (uint8_t)(token >> 8);
+        } else {
+            best_len = 1;
+            dst[len++] = data[i];
+        }
+        bit++;
+
+        for (size_t end = i + best_len; i < end; i++) {
+            uint32_t index = lz->position & _LZ_MASK;
+            lz->window[index] = data[i];
+            if ((i + 2U) < size) {
+                uint32_t hash = _lz_hash(&data[i]);
+                lz->prev[index] = lz->head[hash];
+                lz->head[hash] = (uint16_t)lz->position;
+            }
+            lz->position++;
+        }
+    }
+    return len;
+}
+
+#    endif  // LOG_COMPRESS_ENABLED == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_COMPRESS_DECODER == 1U
+
+/* Returns false if block doesn't fit the window rules, stream is out of sync then */
+static bool _lz_uncompress(log_lz_t *lz, uint8_t const *src, size_t size, bool is_stored, size_t *len) {
+    *len = 0;
+    if (is_stored == true) {
+        if (size > _BLOCK_INPUT) {
+            return false;
+        }
+        for (size_t i = 0; i < size; i++) {
+            lz->block[i] = src[i];
+            lz->window[lz->position & _LZ_MASK] = src[i];
+            lz->position++;
+        }
+        *len = size;
+        return true;
+    }
+
+    uint8_t const *end = &src[size];
+    while (src < end) {
+        uint8_t flags = *src++;
+        for (uint32_t bit = 0; (bit < 8U) && (src < end); bit++) {
+            if ((flags & (1U << bit)) == 0) {
+                if (*len == _BLOCK_INPUT) {
+                    return false;
+                }
+                lz->block[(*len)++] = *src;
+                lz->window[lz->position & _LZ_MASK] = *src++;
+                lz->position++;
+                continue;
+            }
+
+            if ((end - src) < 2) {
+                return false;
+            }
+            uint32_t token = (uint32_t)src[0] | ((uint32_t)src[1] << 8);
+            src += 2;
+            uint32_t distance = (token & ((1U << _LZ_DISTANCE_BITS) - 1U)) + 1U;
+            size_t match = (token >> _LZ_DISTANCE_BITS) + _LZ_MIN_MATCH;
+            if ((*len + match) > _BLOCK_INPUT) {
+                return false;
+            }
+            for (size_t n = 0; n < match; n++) {
+                uint8_t byte = lz->window[(lz->position - distance) & _LZ_MASK];
+                lz->block[(*len)++] = byte;
+                lz->window[lz->position & _LZ_MASK] = byte;
+                lz->position++;
+            }
+        }
+    }
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+size_t log_uncompress(const uint8_t *data, size_t size) {
+    const uint8_t *src = data;
+    uint8_t const *end = &data[size];
+    log_lz_t *lz = &_ctx.lz;
+
+    while ((src < end) && (_ctx.io != NULL)) {
+        if ((*src & 0xFCU) != _BLOCK_MAGIC) {
+            src++; /* Garbage, look for the next block */
+            continue;
+        }
+        if ((end - src) < (ptrdiff_t)_BLOCK_HEADER) {
+            break; /* Incomplete header */
+        }
+        size_t payload_size = (size_t)src[1] | ((size_t)src[2] << 8);
+        if (payload_size > _BLOCK_MAX_PAYLOAD) {
+            src++;
+            continue;
+        }
+        if ((size_t)(end - src) < (_BLOCK_HEADER + payload_size)) {
+            break; /* Incomplete payload */
+        }
+
+        uint8_t header = *src;
+        src += _BLOCK_HEADER;
+        if ((header & _BLOCK_RESET) != 0) {
+            _lz_reset(lz);
+            lz->is_synced = true;
+        }
+        if (lz->is_synced == true) {
+            size_t len = 0;
+            lz->is_synced = _lz_uncompress(lz, src, payload_size, (header & _BLOCK_STORED) != 0, &len);
+            if (lz->is_synced == true) {
+                _ctx.io->write(lz->block, len);
+            }
+        }
+        src += payload_size;
+    }
+
+    return (size_t)(src - data);
+}
+
+#    endif  // LOG_COMPRESS_DECODER == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if _RING_ENABLED == 1U
+
+/* Writes batch to 'write' sink, NULL is io */
+static void _log_writev(void (*write)(const uint8_t *data, size_t size), log_iovec_t const *iov, size_t count) {
+#        if (LOG_IO_WRITEV == 1U) && (LOG_COMPRESS_ENABLED == 0U) && (LOG_IO_WRITE_ASYNC == 0U)
+    if (write == NULL) {
+        uint32_t start = _STATS_CLOCK();
+        _ctx.io->writev(iov, count);
+        _STATS_ADD(write_time, _STATS_CLOCK() - start);
+        return;
+    }
+#        endif  // (LOG_IO_WRITEV == 1U) && (LOG_COMPRESS_ENABLED == 0U) && (LOG_IO_WRITE_ASYNC == 0U)
+    if (write == NULL) {
+        write = _io_write;
+    }
+    for (size_t i = 0; i < count; i++) {
+        write(iov[i].data, iov[i].size);
+    }
+}
+
+#    endif  // _RING_ENABLED == 1U
+
+/* -------------------------------------------------------------------------- */
+
+/*
+    Line is built on the stack when it goes to the ring or when threads format in parallel,
+    interrupts and threads of asynchronous mode don't wait for each other,
+    otherwise shared buffer is used under the lock
+*/
+static inline char *_line_acquire(char *stack_buff) {
+#    if LOG_ISR_QUEUE == 1U
+    if (_ctx.io->is_isr()) {
+        return stack_buff;
+    }
+#    endif  // LOG_ISR_QUEUE == 1U
+
+#    if _LINE_SHARED == 0U
+    return stack_buff;
+#    else
+    (void)stack_buff;
+#        if LOG_THREADSAFE_ENABLED == 1U
+    uint32_t start = _STATS_CLOCK();
+    _ctx.io->lock();
+    _STATS_ADD(lock_time, _STATS_CLOCK() - start);
+#        endif  // LOG_THREADSAFE_ENABLED == 1U
+    return _ctx.buff;
+#    endif  // _LINE_SHARED == 0U
+}
+
+/* -------------------------------------------------------------------------- */
+
+static inline void _line_release(char const *buff) {
+#    if (_LINE_SHARED == 1U) && (LOG_THREADSAFE_ENABLED == 1U)
+    if (buff == _ctx.buff) {
+        _ctx.io->unlock();
+    }
+#    else
+    (void)buff;
+#    endif  // (_LINE_SHARED == 1U) && (LOG_THREADSAFE_ENABLED == 1U)
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* With LOG_PARALLEL_FORMAT line is formatted without the lock, it's taken only to write it */
+static inline bool _output_lock(void) {
+#    if _OUTPUT_LOCK == 1U
+#        if LOG_ISR_QUEUE == 1U
+    if (_ctx.io->is_isr()) {
+        return false;
+    }
+#        endif  // LOG_ISR_QUEUE == 1U
+    uint32_t start = _STATS_CLOCK();
+    _ctx.io->lock();
+    _STATS_ADD(lock_time, _STATS_CLOCK() - start);
+    return true;
+#    else
+    return false;
+#    endif  // _OUTPUT_LOCK == 1U
+}
+
+/* -------------------------------------------------------------------------- */
+
+static inline void _output_unlock(bool is_locked) {
+#    if _OUTPUT_LOCK == 1U
+    if (is_locked == true) {
+        _ctx.io->unlock();
+    }
+#    else
+    (void)is_locked;
+#    endif  // _OUTPUT_LOCK == 1U
+}
+
+/* -------------------------------------------------------------------------- */
+
+static inline log_line_t _line_open(char *buff, log_mask_t level_mask) {
+    log_line_t line = { .data = &buff[_LINE_HEADROOM], .size = _LINE_LENGTH, .len = 0, .mask = level_mask };
+#    if LOG_IO_RESERVE == 1U
+    /* Only the shared buffer is replaced, interrupts and local lines keep their buffers */
+    if (buff == _ctx.buff) {
+        _line_reserve(&line);
+    }
+#    endif  // LOG_IO_RESERVE == 1U
+    return line;
+}
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_IO_RESERVE == 1U
+
+/* Sinks take the line after io and strip colors in place, so they need the copy path */
+static void _line_reserve(log_line_t *line) {
+#        if LOG_SINKS_ENABLED == 1U
+    if (_ctx.sinks_count > 0) {
+        return;
+    }
+#        endif  // LOG_SINKS_ENABLED == 1U
+#        if (LOG_SINKS_ENABLED == 1U) || (LOG_RECORDER_ENABLED == 1U)
+    if ((line->mask & _ctx.io_mask) == 0) {
+        return;
+    }
+#        endif  // (LOG_SINKS_ENABLED == 1U) || (LOG_RECORDER_ENABLED == 1U)
+#        if LOG_ISR_QUEUE == 1U
+    /* io isn't written while memory is reserved, lines of interrupts go first */
+    (void)_ring_drain(&_ctx.ring, LOG_ISR_FLUSH_BUDGET);
+#        endif  // LOG_ISR_QUEUE == 1U
+
+    char *data = (char *)_ctx.io->reserve(line->size);
+    if (data != NULL) {
+        line->data = data;
+        line->is_reserved = true;
+    }
+}
+
+#    endif  // LOG_IO_RESERVE == 1U
+
+/* -------------------------------------------------------------------------- */
+
+/* Returns bytes to write and empties the line */
+static log_iovec_t _line_finish(log_line_t *line) {
+#    if LOG_DEFERRED_FORMAT == 1U
+    /* Text is wrapped into frame to keep binary stream parsable, header is placed to the headroom */
+    uint8_t *frame = (uint8_t *)line->data - ((line->len < 0x80U) ? 2U : 3U);
+    frame[0] = _FRAME_MAGIC | _FRAME_TEXT;
+    (void)_put_varint(&frame[1], (uint8_t *)line->data, line->len);
+    log_iovec_t iov = { .data = frame, .size = (size_t)((uint8_t *)line->data - frame) + line->len };
+#    else
+    log_iovec_t iov = { .data = (uint8_t const *)line->data, .size = line->len };
+#    endif  // LOG_DEFERRED_FORMAT == 1U
+    line->len = 0;
+#    if LOG_SINKS_ENABLED == 1U
+    line->date_len = 0;
+    line->uptime_len = 0;
+#    endif  // LOG_SINKS_ENABLED == 1U
+    return iov;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _line_flush(log_line_t *line) {
+    if (line->len == 0) {
+#    if LOG_IO_RESERVE == 1U
+        if (line->is_reserved == true) {
+            _ctx.io->commit(0);
+            line->is_reserved = false;
+        }
+#    endif  // LOG_IO_RESERVE == 1U
+        return;
+    }
+    line->flushes++;
+#    if LOG_INSTANCES_ENABLED == 1U
+    /* Instance writes to its own io, recorder, sinks, queues and compression belong to the global logger */
+    if (line->instance != NULL) {
+        line->instance->io->write((uint8_t const *)line->data, line->len);
+        _STATS_ADD(levels[_stats_level(line->mask)].bytes, line->len);
+        line->len = 0;
+        return;
+    }
+#    endif  // LOG_INSTANCES_ENABLED == 1U
+#    if (LOG_SINKS_ENABLED == 1U) || (LOG_RECORDER_ENABLED == 1U)
+    bool is_io = ((line->mask & _ctx.io_mask) != 0);
+#    else
+    bool is_io = true;
+#    endif  // (LOG_SINKS_ENABLED == 1U) || (LOG_RECORDER_ENABLED == 1U)
+    bool is_written = false;
+#    if LOG_STATS_ENABLED == 1U
+    size_t bytes = line->len;
+#    endif  // LOG_STATS_ENABLED == 1U
+    bool is_locked = _output_lock();
+#    if LOG_RECORDER_ENABLED == 1U
+    if ((line->mask & _ctx.recorder_mask) != 0) {
+        _recorder_put((uint8_t const *)line->data, line->len);
+    }
+#    endif  // LOG_RECORDER_ENABLED == 1U
+
+#    if LOG_SINKS_ENABLED == 1U
+    /* Colors are removed in place, so sinks which keep them take the line first */
+    _sinks_write(line, true);
+    if (is_io == true) {
+        is_written = _line_write(line, (uint8_t const *)line->data, line->len);
+    }
+    _sinks_write(line, false);
+    (void)_line_finish(line);
+#    else
+    log_iovec_t iov = _line_finish(line);
+    if (is_io == true) {
+        is_written = _line_write(line, iov.data, iov.size);
+    }
+#    endif  // LOG_SINKS_ENABLED == 1U
+#    if LOG_IO_FLUSH == 1U
+    if (is_io == true) {
+        _io_flush(line->mask);
+    }
+#    endif  // LOG_IO_FLUSH == 1U
+    _output_unlock(is_locked);
+#    if LOG_STATS_ENABLED == 1U
+    if (is_written == true) {
+        _STATS_ADD(levels[_stats_level(line->mask)].bytes, bytes);
+    }
+#    else
+    (void)is_written;
+#    endif  // LOG_STATS_ENABLED == 1U
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Reserved line is already in sink memory, it's committed instead of copying */
+static inline bool _line_write(log_line_t *line, uint8_t const *data, size_t size) {
+#    if LOG_IO_RESERVE == 1U
+    if (line->is_reserved == true) {
+        uint32_t start = _STATS_CLOCK();
+        _ctx.io->commit(size);
+        _STATS_ADD(write_time, _STATS_CLOCK() - start);
+        /* Memory belongs to the sink now, the rest of too long line goes by the copy path */
+        line->data = &_ctx.buff[_LINE_HEADROOM];
+        line->is_reserved = false;
+        return true;
+    }
+#    endif  // LOG_IO_RESERVE == 1U
+    return _log_write(line->mask, data, size);
+}
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_SINKS_ENABLED == 1U
+
+/* Line is formatted once, every sink takes the part of it which its timestamp style needs */
+static void _sinks_write(log_line_t *line, bool is_color) {
+#        if LOG_ISR_QUEUE == 1U
+    bool is_isr = (_ctx.sinks_count > 0) && _ctx.io->is_isr();
+#        endif  // LOG_ISR_QUEUE == 1U
+#        if LOG_ENABLED_COLOR == 1U
+    bool is_stripped = false;
+#        endif  // LOG_ENABLED_COLOR == 1U
+
+    for (size_t i = 0; i < _ctx.sinks_count; i++) {
+        log_sink_slot_t *slot = &_ctx.sinks[i];
+        if (((line->mask & slot->sink.mask) == 0) || (slot->sink.is_color != is_color)) {
+            continue;
+        }
+#        if LOG_ISR_QUEUE == 1U
+        if ((is_isr == true) && (slot->sink.is_queued == false)) {
+            continue; /* Interrupt doesn't wait for sink, it writes only to queues */
+        }
+#        endif  // LOG_ISR_QUEUE == 1U
+#        if LOG_ENABLED_COLOR == 1U
+        if ((is_color == false) && (is_stripped == false)) {
+            _line_strip_colors(line);
+            is_stripped = true;
+        }
+#        endif  // LOG_ENABLED_COLOR == 1U
+
+        size_t skip = 0;
+        if (slot->sink.timestamp == LOG_SINK_TIMESTAMP_NONE) {
+            skip = line->date_len + line->uptime_len;
+        } else if (slot->sink.timestamp == LOG_SINK_TIMESTAMP_UPTIME) {
+            skip = line->date_len;
+        }
+        uint8_t const *data = (uint8_t const *)&line->data[skip];
+        size_t size = line->len - skip;
+        if (size == 0) {
+            continue;
+        }
+
+#        if _SINK_QUEUE_ENABLED == 1U
+        if (slot->sink.is_queued == true) {
+            (void)_ring_push(&slot->queue, line->mask, data, size);
+            continue;
+        }
+#        endif  // _SINK_QUEUE_ENABLED == 1U
+        slot->sink.write(data, size);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+#        if LOG_ENABLED_COLOR == 1U
+
+/* Removes "ESC [ ... m" sequences in place, timestamp lengths are updated too */
+static void _line_strip_colors(log_line_t *line) {
+    size_t date_end = line->date_len;
+    size_t uptime_end = line->date_len + line->uptime_len;
+    size_t len = 0;
+    size_t i = 0;
+    while (i < line->len) {
+        if (i == date_end) {
+            line->date_len = len;
+        }
+        if (i == uptime_end) {
+            line->uptime_len = len - line->date_len;
+        }
+
+        if (line->data[i] != '\033') {
+            line->data[len++] = line->data[i++];
+            continue;
+        }
+        i++;
+        if ((i < line->len) && (line->data[i] == '[')) {
+            i++;
+            while ((i < line->len) && (line->data[i] >= 0x30) && (line->data[i] <= 0x3F)) {
+                i++;
+            }
+            if (i < line->len) {
+                i++; /* Final byte, 'm' for colors */
+            }
+        }
+    }
+    if (date_end >= line->len) {
+        line->date_len = len;
+    }
+    if (uptime_end >= line->len) {
+        line->uptime_len = len - line->date_len;
+    }
+    line->len = len;
+}
+
+#        endif  // LOG_ENABLED_COLOR == 1U
+#    endif      // LOG_SINKS_ENABLED == 1U
+
+/* -------------------------------------------------------------------------- */
+
+static void _line_put(log_line_t *line, void const *data, size_t size) {
+    uint8_t const *src = (uint8_t const *)data;
+    while (size > 0) {
+        if (line->len == line->size) {
+            _line_flush(line);
+        }
+        size_t chunk = line->size - line->len;
+        if (chunk > size) {
+            chunk = size;
+        }
+        memcpy(&line->data[line->len], src, chunk);
+        line->len += chunk;
+        src += chunk;
+        size -= chunk;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Accepts result of snprintf to the tail of the line */
+static void _line_commit(log_line_t *line, int len) {
+    size_t room = line->size - line->len;
+    if (len < 0) {
+        _STATS_ADD(snprintf_errors, 1U);
+        _line_put(line, SNPRINTF_ERROR, sizeof(SNPRINTF_ERROR) - 1);
+    } else if ((size_t)len < room) {
+        line->len += (size_t)len;
+    } else if (room > 0) {
+        line->len += room - 1U;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _line_print(log_line_t *line, const char *format, ...) {
+#    if LOG_BUILTIN_PRINTF == 1U
+    va_list args;
+    va_start(args, format);
+    _line_vprint(line, format, args);
+    va_end(args);
+#    else
+    for (uint32_t attempt = 0; attempt < 2U; attempt++) {
+        size_t room = line->size - line->len;
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(&line->data[line->len], room, format, args);
+        va_end(args);
+
+        if ((len < 0) || ((size_t)len < room) || (line->len == 0)) {
+            _line_commit(line, len);
+            return;
+        }
+        _line_flush(line); /* No room, send collected part and try again */
+    }
+#    endif  // LOG_BUILTIN_PRINTF == 1U
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _line_prefix(log_line_t *line) {
+#    if LOG_TIMESTAMP_ENABLED == 1
+    log_io_t const *io = _ctx.io;
+#        if LOG_TIMESTAMP_DELTA == 1U
+    log_stamp_t *stamp = &_ctx.stamp;
+#        endif  // LOG_TIMESTAMP_DELTA == 1U
+#        if LOG_INSTANCES_ENABLED == 1U
+    /* Instance has its own clocks and delta */
+    if (line->instance != NULL) {
+        io = line->instance->io;
+#            if LOG_TIMESTAMP_DELTA == 1U
+        stamp = &line->instance->stamp;
+#            endif  // LOG_TIMESTAMP_DELTA == 1U
+    }
+#        endif  // LOG_INSTANCES_ENABLED == 1U
+#        if LOG_SINKS_ENABLED == 1U
+    size_t start = line->len;
+#        endif  // LOG_SINKS_ENABLED == 1U
+#        if LOG_TIMESTAMP_FORMAT > 0U
+    _line_commit(line, _print_date_time(&line->data[line->len], line->size - line->len, io));
+#            if LOG_SINKS_ENABLED == 1U
+    line->date_len = line->len - start;
+    start = line->len;
+#            endif  // LOG_SINKS_ENABLED == 1U
+#        endif      // LOG_TIMESTAMP_FORMAT > 0
+#        if LOG_TIMESTAMP_DELTA == 1U
+    _line_commit(line, _print_stamp(&line->data[line->len], line->size - line->len, _stamp_now(io), stamp));
+#        else
+    _line_commit(line, _print_uptime(&line->data[line->len], line->size - line->len, _stamp_now(io)));
+#        endif  // LOG_TIMESTAMP_DELTA == 1U
+#        if LOG_SINKS_ENABLED == 1U
+    line->uptime_len = line->len - start;
+#        endif  // LOG_SINKS_ENABLED == 1U
+#    else
+    (void)line;
+#    endif  // LOG_TIMESTAMP_ENABLED == 1
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Appends " XX" per byte, encodes by table into the line directly and flushes only when the line is full */
+static void _line_hex(log_line_t *line, uint8_t const *data, size_t size) {
+    while (size > 0) {
+        size_t count = (line->size - line->len) / 3U;
+        if (count == 0) {
+            _line_flush(line);
+            continue;
+        }
+        if (count > size) {
+            count = size;
+        }
+
+        char *dst = &line->data[line->len];
+        for (size_t i = 0; i < count; i++) {
+            dst[0] = ' ';
+            dst[1] = _HEX_DIGITS[data[i] >> 4U];
+            dst[2] = _HEX_DIGITS[data[i] & 0x0FU];
+            dst += 3;
+        }
+        line->len += count * 3U;
+        data += count;
+        size -= count;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Writes value in 'digits' width with leading zeros, zero width means no padding, returns end of digits */
+static char *_put_uint(char *dst, uint64_t value, uint32_t digits) {
+    char text[20];
+    uint32_t count = 0;
+    if (value <= UINT32_MAX) {
+        uint32_t value32 = (uint32_t)value;
+        do {
+            text[count++] = (char)('0' + (value32 % 10U));
+            value32 /= 10U;
+        } while (value32 != 0);
+    } else {
+        do {
+            text[count++] = (char)('0' + (value % 10U));
+            value /= 10U;
+        } while (value != 0);
+    }
+    while (count < digits) {
+        text[count++] = '0';
+    }
+
+    while (count > 0) {
+        *dst++ = text[--count];
+    }
+    return dst;
+}
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_TIMESTAMP_ENABLED == 1U
+
+/* Copies text as snprintf does, returns full length even if it was truncated */
+static int _put_text(char *dst, size_t size, char const *text, size_t len) {
+    if (size > 0) {
+        size_t count = (len < size) ? len : (size - 1U);
+        memcpy(dst, text, count);
+        dst[count] = '\0';
+    }
+    return (int)len;
+}
+
+#    endif  // LOG_TIMESTAMP_ENABLED == 1U
+
+/* -------------------------------------------------------------------------- */
+
+static void _line_float(log_line_t *line, double value, uint32_t decimals) {
+    for (uint32_t attempt = 0; attempt < 2U; attempt++) {
+        size_t room = line->size - line->len;
+        int len = _log_ftoa(&line->data[line->len], room, value, decimals);
+        if (((size_t)len < room) || (line->len == 0)) {
+            _line_commit(line, len);
+            return;
+        }
+        _line_flush(line); /* No room, send collected part and try again */
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_BUILTIN_PRINTF == 1U
+
+/*
+    Subset of printf: d i u x X o c s p f F e E g G a A and %%, flags, width, precision, '*' and length modifiers.
+    Output is put into the line which is flushed when it's full, so message length isn't limited.
+*/
+static void _line_vprint(log_line_t *line, const char *format, va_list args) {
+    va_list ap;
+    va_copy(ap, args);
+
+    while (*format != '\0') {
+        const char *text = format;
+        while ((*format != '\0') && (*format != '%')) {
+            format++;
+        }
+        _line_put(line, text, (size_t)(format - text));
+        if (*format == '\0') {
+            break;
+        }
+
+        _format_spec_t spec;
+        const char *start = format;
+        format = _parse_spec(format + 1, &spec);
+        if (spec.width_arg == true) {
+            int width = va_arg(ap, int);
+            if (width < 0) {
+                spec.is_left = true;
+                width = -width;
+            }
+            spec.width = (uint32_t)width;
+        }
+        if (spec.precision_arg == true) {
+            spec.precision = va_arg(ap, int);
+            if (spec.precision < 0) {
+                spec.precision = -1; /* Negative precision is taken as if the precision were omitted */
+            }
+        }
+
+        switch (spec.conversion) {
+            case '%':
+                _line_put(line, "%", 1U);
+                break;
+            case 'd':
+            case 'i': {
+                int64_t value = _arg_signed(spec.length, &ap);
+                char sign = (spec.is_plus == true) ? '+' : ((spec.is_space == true) ? ' ' : '\0');
+                if (value < 0) {
+                    sign = '-';
+                }
+                _line_integer(line, &spec, (value < 0) ? (0U - (uint64_t)value) : (uint64_t)value, sign);
+                break;
+            }
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                _line_integer(line, &spec, _arg_unsigned(spec.length, &ap), '\0');
+                break;
+            case 'c': {
+                char c = (char)va_arg(ap, int);
+                _line_field(line, &spec, NULL, 0, 0, &c, 1U);
+                break;
+            }
+            case 's': {
+                const char *string = va_arg(ap, const char *);
+                if (string == NULL) {
+                    string = ((spec.precision < 0) || (spec.precision >= 6)) ? "(null)" : "";
+                }
+                size_t len = 0;
+                while ((string[len] != '\0') && ((spec.precision < 0) || (len < (size_t)spec.precision))) {
+                    len++;
+                }
+                _line_field(line, &spec, NULL, 0, 0, string, len);
+                break;
+            }
+            case 'p': {
+                void *pointer = va_arg(ap, void *);
+                if (pointer == NULL) {
+                    _line_field(line, &spec, NULL, 0, 0, "(nil)", 5U);
+                    break;
+                }
+                spec.conversion = 'x';
+                spec.is_alternate = true;
+                spec.precision = -1;
+                _line_integer(line, &spec, (uintptr_t)pointer, '\0');
+                break;
+            }
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                if (spec.length == _LENGTH_LONG_DOUBLE) {
+                    _line_double(line, &spec, (double)va_arg(ap, long double));
+                } else {
+                    _line_double(line, &spec, va_arg(ap, double));
+                }
+                break;
+            case 'n':
+                (void)va_arg(ap, void *);
+                break;
+            default:
+                _line_put(line, start, (size_t)(format - start)); /* Unknown conversion is printed as is */
+                break;
+        }
+    }
+
+    va_end(ap);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _line_fill(log_line_t *line, char c, size_t count) {
+    static const char _SPACES[] = "                ";
+    static const char _ZEROS[] = "0000000000000000";
+    char const *text = (c == '0') ? _ZEROS : _SPACES;
+    while (count > 0) {
+        size_t chunk = (count < (sizeof(_SPACES) - 1U)) ? count : (sizeof(_SPACES) - 1U);
+        _line_put(line, text, chunk);
+        count -= chunk;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Field is prefix, zeros and text aligned in its width, zero padding is added to 'zeros' by caller */
+static void _line_field(log_line_t *line, _format_spec_t const *spec, char const *prefix, size_t prefix_len,
+                        size_t zeros, char const *text, size_t size) {
+    size_t len = prefix_len + zeros + size;
+    size_t pad = (spec->width > len) ? (spec->width - len) : 0;
+    if (spec->is_left == false) {
+        _line_fill(line, ' ', pad);
+    }
+    _line_put(line, prefix, prefix_len);
+    _line_fill(line, '0', zeros);
+    _line_put(line, text, size);
+    if (spec->is_left == true) {
+        _line_fill(line, ' ', pad);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _line_integer(log_line_t *line, _format_spec_t const *spec, uint64_t value, char sign) {
+    static const char _LOWER_DIGITS[] = "0123456789abcdef";
+    char const *digits = (spec->conversion == 'X') ? _HEX_DIGITS : _LOWER_DIGITS;
+    uint32_t base = 10U;
+    if ((spec->conversion == 'x') || (spec->conversion == 'X')) {
+        base = 16U;
+    } else if (spec->conversion == 'o') {
+        base = 8U;
+    }
+
+    char text[24];
+    size_t count = 0;
+    bool is_zero_value = (value == 0);
+    if ((is_zero_value == false) || (spec->precision != 0)) {
+        char *end = &text[sizeof(text)];
+        if (value <= UINT32_MAX) {
+            uint32_t value32 = (uint32_t)value;
+            do {
+                *--end = digits[value32 % base];
+                value32 /= base;
+            } while (value32 != 0);
+        } else {
+            do {
+                *--end = digits[value % base];
+                value /= base;
+            } while (value != 0);
+        }
+        count = (size_t)(&text[sizeof(text)] - end);
+    }
+
+    char prefix[3];
+    size_t prefix_len = 0;
+    if (sign != '\0') {
+        prefix[prefix_len++] = sign;
+    }
+    if ((spec->is_alternate == true) && (base == 16U) && (is_zero_value == false)) {
+        prefix[prefix_len++] = '0';
+        prefix[prefix_len++] = spec->conversion;
+    }
+
+    size_t zeros = ((spec->precision > 0) && ((size_t)spec->precision > count)) ? ((size_t)spec->precision - count) : 0;
+    if ((spec->is_alternate == true) && (base == 8U) && (zeros == 0) &&
+        ((count == 0) || (text[sizeof(text) - count] != '0'))) {
+        zeros = 1U;
+    }
+    if ((spec->is_zero == true) && (spec->is_left == false) && (spec->precision < 0)) {
+        size_t len = prefix_len + zeros + count;
+        zeros += (spec->width > len) ? (spec->width - len) : 0;
+    }
+    _line_field(line, spec, prefix, prefix_len, zeros, &text[sizeof(text) - count], count);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Digits are streamed by _ftoa(), length is counted by dry run only when the field is aligned */
+static void _line_double(log_line_t *line, _format_spec_t const *spec, double value) {
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    bool is_finite = (((bits >> 52) & 0x7FFU) != 0x7FFU);
+
+    char sign = (spec->is_plus == true) ? '+' : ((spec->is_space == true) ? ' ' : '\0');
+    if ((bits >> 63) != 0) {
+        sign = '-';
+        value = -value;
+    }
+    if (is_finite == false) {
+        bool is_upper = (spec->conversion >= 'A') && (spec->conversion <= 'Z');
+        char const *text = ((bits & 0x000FFFFFFFFFFFFFULL) == 0) ? (is_upper ? "INF" : "inf") : (is_upper ? "NAN" : "nan");
+        _line_field(line, spec, &sign, (sign != '\0') ? 1U : 0U, 0, text, 3U);
+        return;
+    }
+    if ((spec->conversion == 'a') || (spec->conversion == 'A')) {
+        _line_hex_double(line, spec, sign, value);
+        return;
+    }
+
+    uint32_t decimals = (spec->precision < 0) ? 6U : (uint32_t)spec->precision;
+    if (((spec->conversion == 'f') || (spec->conversion == 'F')) && (decimals <= 9U)) {
+        _line_fixed(line, spec, sign, value, decimals);
+        return;
+    }
+
+    /* Exact digits are needed for e, g and long fraction of f */
+    _dec_t dec;
+    _dec_init(&dec, value);
+    if ((spec->conversion == 'g') || (spec->conversion == 'G')) {
+        /* Style is chosen by exponent of the value rounded to the precision */
+        uint32_t digits = (decimals == 0) ? 1U : decimals;
+        int32_t carry = _dec_round(&dec, dec.top - (int32_t)digits + 1);
+        int32_t exponent = (carry > dec.top) ? carry : dec.top;
+        bool is_trim = (spec->is_alternate == false);
+        if ((exponent < (int32_t)digits) && (exponent >= -4)) {
+            _line_decimal(line, spec, sign, &dec, false, (uint32_t)((int32_t)digits - 1 - exponent), is_trim);
+        } else {
+            _line_decimal(line, spec, sign, &dec, true, digits - 1U, is_trim);
+        }
+    } else {
+        bool is_exponent = (spec->conversion == 'e') || (spec->conversion == 'E');
+        _line_decimal(line, spec, sign, &dec, is_exponent, decimals, false);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Fixed point of up to 9 decimals, digits are streamed by _ftoa(), length is counted by dry run only when aligned */
+static void _line_fixed(log_line_t *line, _format_spec_t const *spec, char sign, double value, uint32_t decimals) {
+    bool is_point = (spec->is_alternate == true) && (decimals == 0);
+
+    size_t pad = 0;
+    if (spec->width > 0) {
+        _ftoa_out_t dry = { .dst = NULL, .size = 0, .len = 0, .line = NULL };
+        _ftoa(&dry, value, decimals);
+        size_t len = ((sign != '\0') ? 1U : 0U) + dry.len + (is_point ? 1U : 0U);
+        pad = (spec->width > len) ? (spec->width - len) : 0;
+    }
+    bool is_zero_pad = (spec->is_zero == true) && (spec->is_left == false);
+
+    if ((spec->is_left == false) && (is_zero_pad == false)) {
+        _line_fill(line, ' ', pad);
+    }
+    if (sign != '\0') {
+        _line_put(line, &sign, 1U);
+    }
+    if (is_zero_pad == true) {
+        _line_fill(line, '0', pad);
+    }
+    _ftoa_out_t out = { .dst = NULL, .size = 0, .len = 0, .line = line };
+    _ftoa(&out, value, decimals);
+    if (is_point == true) {
+        _line_put(line, ".", 1U);
+    }
+    if (spec->is_left == true) {
+        _line_fill(line, ' ', pad);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/*
+    Prints exact digits rounded to the precision in e or f style,
+    trim drops trailing zeros of the fraction and the point without them as g does
+*/
+static void _line_decimal(log_line_t *line, _format_spec_t const *spec, char sign, _dec_t const *dec, bool is_exponent,
+                          uint32_t precision, bool is_trim) {
+    int32_t low = is_exponent ? (dec->top - (int32_t)precision) : -(int32_t)precision;
+    int32_t carry = _dec_round(dec, low);
+    int32_t top = (is_exponent || (dec->top > 0)) ? dec->top : 0;
+    if (carry > top) {
+        /* 9.99 is rounded to 10.0, e style keeps the number of digits */
+        top = carry;
+        low += is_exponent ? 1 : 0;
+    }
+    int32_t point = is_exponent ? top : 0;
+
+    int32_t end = low;
+    if (is_trim == true) {
+        while ((end < point) && ((end < carry) || ((end > carry) && (_dec_digit(dec, end) == 0)))) {
+            end++;
+        }
+    }
+    bool is_point = (end < point) || (spec->is_alternate == true);
+
+    char exponent[8];
+    size_t exponent_len = 0;
+    if (is_exponent == true) {
+        exponent[exponent_len++] = (spec->conversion == 'E') || (spec->conversion == 'G') ? 'E' : 'e';
+        exponent[exponent_len++] = (point < 0) ? '-' : '+';
+        exponent_len = (size_t)(_put_uint(&exponent[exponent_len], (uint64_t)((point < 0) ? -point : point), 2U) - exponent);
+    }
+
+    size_t len = ((sign != '\0') ? 1U : 0U) + (size_t)(top - end + 1) + (is_point ? 1U : 0U) + exponent_len;
+    size_t pad = (spec->width > len) ? (spec->width - len) : 0;
+    bool is_zero_pad = (spec->is_zero == true) && (spec->is_left == false);
+
+    if ((spec->is_left == false) && (is_zero_pad == false)) {
+        _line_fill(line, ' ', pad);
+    }
+    if (sign != '\0') {
+        _line_put(line, &sign, 1U);
+    }
+    if (is_zero_pad == true) {
+        _line_fill(line, '0', pad);
+    }
+    char text[32];
+    size_t count = 0;
+    for (int32_t power = top; power >= end; power--) {
+        uint32_t digit = (power < carry) ? 0 : _dec_digit(dec, power);
+        text[count++] = (char)('0' + ((power == carry) ? (digit + 1U) : digit));
+        if ((power == point) && (is_point == true)) {
+            text[count++] = '.';
+        }
+        if (count >= (sizeof(text) - 1U)) {
+            _line_put(line, text, count);
+            count = 0;
+        }
+    }
+    _line_put(line, text, count);
+    _line_put(line, exponent, exponent_len);
+    if (spec->is_left == true) {
+        _line_fill(line, ' ', pad);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Hexadecimal mantissa and binary exponent as glibc prints them, subnormals keep leading 0 */
+static void _line_hex_double(log_line_t *line, _format_spec_t const *spec, char sign, double value) {
+    static const char _LOWER_DIGITS[] = "0123456789abcdef";
+    char const *digits = (spec->conversion == 'A') ? _HEX_DIGITS : _LOWER_DIGITS;
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t biased = (uint32_t)((bits >> 52) & 0x7FFU);
+    uint64_t mantissa = bits & 0x000FFFFFFFFFFFFFULL;
+    uint32_t lead = (biased == 0) ? 0 : 1U;
+    int32_t exponent = (biased == 0) ? ((mantissa == 0) ? 0 : -1022) : ((int32_t)biased - 1023);
+
+    /* Mantissa has 13 hex digits, the rest of precision is zeros */
+    uint32_t count = 13U;
+    if (spec->precision < 0) {
+        while ((count > 0) && ((mantissa & 0x0FU) == 0)) {
+            mantissa >>= 4;
+            count--;
+        }
+    } else if ((uint32_t)spec->precision < 13U) {
+        uint32_t shift = 4U * (13U - (uint32_t)spec->precision);
+        uint64_t rest = mantissa & ((1ULL << shift) - 1U);
+        uint64_t half = 1ULL << (shift - 1U);
+        mantissa >>= shift;
+        count = (uint32_t)spec->precision;
+        bool is_odd = ((count == 0) ? lead : (uint32_t)mantissa) & 1U;
+        if ((rest > half) || ((rest == half) && is_odd)) {
+            mantissa++;
+            if ((mantissa >> (4U * count)) != 0) {
+                mantissa &= (1ULL << (4U * count)) - 1U;
+                lead++;
+            }
+        }
+    }
+    size_t zeros = ((spec->precision > 0) && ((uint32_t)spec->precision > count)) ? ((uint32_t)spec->precision - count) : 0;
+
+    char prefix[3];
+    size_t prefix_len = 0;
+    if (sign != '\0') {
+        prefix[prefix_len++] = sign;
+    }
+    prefix[prefix_len++] = '0';
+    prefix[prefix_len++] = (spec->conversion == 'A') ? 'X' : 'x';
+
+    char text[16];
+    size_t text_len = 0;
+    text[text_len++] = digits[lead];
+    if ((count > 0) || (zeros > 0) || (spec->is_alternate == true)) {
+        text[text_len++] = '.';
+    }
+    for (uint32_t i = count; i > 0; i--) {
+        text[text_len++] = digits[(mantissa >> (4U * (i - 1U))) & 0x0FU];
+    }
+
+    char tail[8];
+    size_t tail_len = 0;
+    tail[tail_len++] = (spec->conversion == 'A') ? 'P' : 'p';
+    tail[tail_len++] = (exponent < 0) ? '-' : '+';
+    tail_len = (size_t)(_put_uint(&tail[tail_len], (uint64_t)((exponent < 0) ? -exponent : exponent), 0) - tail);
+
+    size_t len = prefix_len + text_len + zeros + tail_len;
+    size_t pad = (spec->width > len) ? (spec->width - len) : 0;
+    bool is_zero_pad = (spec->is_zero == true) && (spec->is_left == false);
+    if ((spec->is_left == false) && (is_zero_pad == false)) {
+        _line_fill(line, ' ', pad);
+    }
+    _line_put(line, prefix, prefix_len);
+    if (is_zero_pad == true) {
+        _line_fill(line, '0', pad);
+    }
+    _line_put(line, text, text_len);
+    _line_fill(line, '0', zeros);
+    _line_put(line, tail, tail_len);
+    if (spec->is_left == true) {
+        _line_fill(line, ' ', pad);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Value is m * 2^e, negative e is taken as m * 5^-e * 10^e, so all digits are integers */
+static void _dec_init(_dec_t *dec, double value) {
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t biased = (uint32_t)((bits >> 52) & 0x7FFU);
+    uint64_t mantissa = bits & 0x000FFFFFFFFFFFFFULL;
+    int32_t power = (biased == 0) ? -1074 : ((int32_t)biased - 1075);
+    mantissa |= (biased == 0) ? 0 : 0x0010000000000000ULL;
+
+    dec->count = 0;
+    dec->shift = 0;
+    dec->top = 0;
+    if (mantissa == 0) {
+        return;
+    }
+    while (mantissa != 0) {
+        dec->limbs[dec->count++] = (uint32_t)(mantissa % 1000000000U);
+        mantissa /= 1000000000U;
+    }
+    while (power != 0) {
+        /* Limb is below 2^30, product with carry fits 64 bits */
+        uint64_t factor = 0;
+        if (power > 0) {
+            uint32_t step = (power > 32) ? 32U : (uint32_t)power;
+            factor = 1ULL << step;
+            power -= (int32_t)step;
+        } else {
+            uint32_t step = (power < -13) ? 13U : (uint32_t)-power;
+            factor = 1U;
+            for (uint32_t i = 0; i < step; i++) {
+                factor *= 5U;
+            }
+            power += (int32_t)step;
+            dec->shift += (int32_t)step;
+        }
+        uint64_t carry = 0;
+        for (uint32_t i = 0; i < dec->count; i++) {
+            carry += (uint64_t)dec->limbs[i] * factor;
+            dec->limbs[i] = (uint32_t)(carry % 1000000000U);
+            carry /= 1000000000U;
+        }
+        while (carry != 0) {
+            dec->limbs[dec->count++] = (uint32_t)(carry % 1000000000U);
+            carry /= 1000000000U;
+        }
+    }
+
+    uint32_t digits = 1U;
+    while ((digits < 9U) && (dec->limbs[dec->count - 1U] >= _POW10[digits])) {
+        digits++;
+    }
+    dec->top = (int32_t)(9U * (dec->count - 1U) + digits) - 1 - dec->shift;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Digit of 10^power */
+static inline uint32_t _dec_digit(_dec_t const *dec, int32_t power) {
+    int32_t position = power + dec->shift;
+    if ((position < 0) || (position >= (int32_t)(9U * dec->count))) {
+        return 0;
+    }
+    return (dec->limbs[(uint32_t)position / 9U] / _POW10[(uint32_t)position % 9U]) % 10U;
+}
+
+/*
+    Rounds digits to 10^low half to even as libc does, returns power of the digit which is incremented,
+    digits below it become zeros, or INT32_MIN when digits are cut down
+*/
+static int32_t _dec_round(_dec_t const *dec, int32_t low) {
+    uint32_t digit = _dec_digit(dec, low - 1);
+    bool is_up = (digit > 5U);
+    if (digit == 5U) {
+        is_up = (_dec_digit(dec, low) & 1U) != 0;
+        for (int32_t power = low - 2; (is_up == false) && ((power + dec->shift) >= 0); power--) {
+            is_up = (_dec_digit(dec, power) != 0);
+        }
+    }
+    if (is_up == false) {
+        return INT32_MIN;
+    }
+    int32_t power = low;
+    while (_dec_digit(dec, power) == 9U) {
+        power++;
+    }
+    return power;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Arguments are read as they were promoted for the length modifier */
+static int64_t _arg_signed(_length_t length, va_list *args) {
+    switch (length) {
+        case _LENGTH_HH:
+            return (signed char)va_arg(*args, int);
+        case _LENGTH_H:
+            return (short)va_arg(*args, int);
+        case _LENGTH_L:
+            return va_arg(*args, long);
+        case _LENGTH_LL:
+            return va_arg(*args, long long);
+        case _LENGTH_J:
+            return va_arg(*args, intmax_t);
+        case _LENGTH_Z:
+        case _LENGTH_T:
+            return va_arg(*args, ptrdiff_t);
+        default:
+            return va_arg(*args, int);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static uint64_t _arg_unsigned(_length_t length, va_list *args) {
+    switch (length) {
+        case _LENGTH_HH:
+            return (unsigned char)va_arg(*args, unsigned int);
+        case _LENGTH_H:
+            return (unsigned short)va_arg(*args, unsigned int);
+        case _LENGTH_L:
+            return va_arg(*args, unsigned long);
+        case _LENGTH_LL:
+            return va_arg(*args, unsigned long long);
+        case _LENGTH_J:
+            return va_arg(*args, uintmax_t);
+        case _LENGTH_Z:
+            return va_arg(*args, size_t);
+        case _LENGTH_T:
+            return (uint64_t)va_arg(*args, ptrdiff_t);
+        default:
+            return va_arg(*args, unsigned int);
+    }
+}
+
+#    endif  // LOG_BUILTIN_PRINTF == 1U
+
+/* -------------------------------------------------------------------------- */
+
+static inline void _ftoa_put(_ftoa_out_t *out, char c) {
+    if (out->line != NULL) {
+        _line_put(out->line, &c, 1U);
+    } else if ((out->len + 1U) < out->size) {
+        out->dst[out->len] = c;
+    }
+    out->len++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _ftoa_put_uint(_ftoa_out_t *out, uint64_t value, uint32_t digits) {
+    char text[20];
+    char *end = _put_uint(text, value, digits);
+    if (out->line != NULL) {
+        _line_put(out->line, text, (size_t)(end - text));
+        out->len += (size_t)(end - text);
+        return;
+    }
+    for (char *digit = text; digit < end; digit++) {
+        _ftoa_put(out, *digit);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/*
+    Fixed point "%.<decimals>f" without libc, output and return value follow snprintf,
+    rounding is half to even of the exact binary value as libc does
+*/
+int _log_ftoa(char *dst, size_t size, double value, uint32_t decimals) {
+    _ftoa_out_t out = { .dst = dst, .size = size, .len = 0, .line = NULL };
+    _ftoa(&out, value, decimals);
+    if (size > 0) {
+        dst[(out.len < size) ? out.len : (size - 1U)] = '\0';
+    }
+    return (int)out.len;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/*
+    Fraction is (rest * scale) >> shift, product takes up to 83 bits and is kept as high * 2^32 + low.
+    Returns sign of the remainder minus half, which decides rounding
+*/
+static int _ftoa_scale(uint64_t rest, uint32_t shift, uint32_t scale, uint64_t *fraction) {
+    if (shift >= 84U) {
+        *fraction = 0;
+        return -1;
+    }
+    uint64_t low = (rest & 0xFFFFFFFFU) * scale;
+    uint64_t high = ((rest >> 32) * scale) + (low >> 32);
+    low &= 0xFFFFFFFFU;
+
+    if (shift <= 32U) {
+        *fraction = (high << (32U - shift)) | (low >> shift);
+        uint64_t remainder = low & ((1ULL << shift) - 1U);
+        uint64_t half = 1ULL << (shift - 1U);
+        return (remainder > half) ? 1 : ((remainder < half) ? -1 : 0);
+    }
+    shift -= 32U;
+    *fraction = high >> shift;
+    uint64_t remainder = high & ((1ULL << shift) - 1U);
+    uint64_t half = 1ULL << (shift - 1U);
+    if (remainder != half) {
+        return (remainder > half) ? 1 : -1;
+    }
+    return (low != 0) ? 1 : 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _ftoa(_ftoa_out_t *out, double value, uint32_t decimals) {
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t exponent = (uint32_t)((bits >> 52) & 0x7FFU);
+    uint64_t mantissa = bits & 0x000FFFFFFFFFFFFFULL;
+
+    if ((bits >> 63) != 0) {
+        _ftoa_put(out, '-');
+    }
+
+    if (exponent == 0x7FFU) {
+        const char *text = (mantissa == 0) ? "inf" : "nan";
+        while (*text != '\0') {
+            _ftoa_put(out, *text++);
+        }
+    } else if (exponent < 1087U) {
+        /* Below 2^64 value is mantissa * 2^-shift, fraction is scaled in integers, so rounding is exact */
+        uint64_t integer = 0;
+        uint64_t fraction = 0;
+        int rest = -1;
+        if (exponent >= 1075U) {
+            integer = (mantissa | 0x0010000000000000ULL) << (exponent - 1075U);
+        } else {
+            uint32_t shift = (exponent == 0) ? 1074U : (1075U - exponent);
+            mantissa |= (exponent == 0) ? 0 : 0x0010000000000000ULL;
+            integer = (shift < 64U) ? (mantissa >> shift) : 0;
+            rest = _ftoa_scale((shift < 64U) ? (mantissa & ((1ULL << shift) - 1U)) : mantissa,
+                               shift,
+                               _POW10[decimals],
+                               &fraction);
+        }
+        bool is_odd = ((decimals == 0) ? integer : fraction) & 1U;
+
+        if ((rest > 0) || ((rest == 0) && is_odd)) {
+            fraction++;
+            if (fraction == _POW10[decimals]) {
+                fraction = 0;
+                integer++; /* 2^64 - 1 can't be here, doubles around it are multiples of 2048 */
+            }
+        }
+
+        _ftoa_put_uint(out, integer, 0);
+        if (decimals > 0) {
+            _ftoa_put(out, '.');
+            _ftoa_put_uint(out, fraction, decimals);
+        }
+    } else {
+        /* Integer mantissa * 2^shift, expanded in base 10^9 limbs to print all digits exactly */
+        uint32_t limbs[36];
+        uint32_t count = 0;
+        uint32_t shift = exponent - 1075U;
+        mantissa |= 0x0010000000000000ULL;
+        while (mantissa != 0) {
+            limbs[count++] = (uint32_t)(mantissa % 1000000000U);
+            mantissa /= 1000000000U;
+        }
+        while (shift > 0) {
+            uint32_t step = (shift > 32U) ? 32U : shift;
+            uint64_t carry = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                carry += (uint64_t)limbs[i] << step;
+                limbs[i] = (uint32_t)(carry % 1000000000U);
+                carry /= 1000000000U;
+            }
+            while (carry != 0) {
+                limbs[count++] = (uint32_t)(carry % 1000000000U);
+                carry /= 1000000000U;
+            }
+            shift -= step;
+        }
+
+        _ftoa_put_uint(out, limbs[--count], 0);
+        while (count > 0) {
+            _ftoa_put_uint(out, limbs[--count], 9U);
+        }
+        if (decimals > 0) {
+            _ftoa_put(out, '.');
+            for (uint32_t i = 0; i < decimals; i++) {
+                _ftoa_put(out, '0');
+            }
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+#    if _SPEC_PARSER == 1U
+
+/* Parses printf specification, format points after '%', returns pointer after conversion */
+static const char *_parse_spec(const char *format, _format_spec_t *spec) {
+    spec->length = _LENGTH_NONE;
+    spec->width_arg = false;
+    spec->precision_arg = false;
+    spec->precision = -1;
+    spec->width = 0;
+    spec->is_left = false;
+    spec->is_zero = false;
+    spec->is_plus = false;
+    spec->is_space = false;
+    spec->is_alternate = false;
+
+    for (;; format++) {
+        if (*format == '-') {
+            spec->is_left = true;
+        } else if (*format == '+') {
+            spec->is_plus = true;
+        } else if (*format == ' ') {
+            spec->is_space = true;
+        } else if (*format == '#') {
+            spec->is_alternate = true;
+        } else if (*format == '0') {
+            spec->is_zero = true;
+        } else {
+            break;
+        }
+    }
+
+    if (*format == '*') {
+        spec->width_arg = true;
+        format++;
+    } else {
+        while ((*format >= '0') && (*format <= '9')) {
+            spec->width = (spec->width * 10U) + (uint32_t)(*format - '0');
+            format++;
+        }
+    }
+
+    if (*format == '.') {
+        format++;
+        spec->precision = 0;
+        if (*format == '*') {
+            spec->precision_arg = true;
+            format++;
+        } else {
+            while ((*format >= '0') && (*format <= '9')) {
+                spec->precision = (spec->precision * 10) + (*format - '0');
+                format++;
+            }
+        }
+    }
+
+    switch (*format) {
+        case 'h':
+            format++;
+            spec->length = _LENGTH_H;
+            if (*format == 'h') {
+                format++;
+                spec->length = _LENGTH_HH;
+            }
+            break;
+        case 'l':
+            format++;
+            spec->length = _LENGTH_L;
+            if (*format == 'l') {
+                format++;
+                spec->length = _LENGTH_LL;
+            }
+            break;
+        case 'j':
+            format++;
+            spec->length = _LENGTH_J;
+            break;
+        case 'z':
+            format++;
+            spec->length = _LENGTH_Z;
+            break;
+        case 't':
+            format++;
+            spec->length = _LENGTH_T;
+            break;
+        case 'L':
+            format++;
+            spec->length = _LENGTH_LONG_DOUBLE;
+            break;
+        default:
+            break;
+    }
+
+    spec->conversion = *format;
+    if (*format != '\0') {
+        format++;
+    }
+    return format;
+}
+
+#    endif  // _SPEC_PARSER == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_DEFERRED_FORMAT == 1U
+
+/* LEB128 encoding, returns NULL if there is no room, NULL dst is passed through */
+static uint8_t *_put_varint(uint8_t *dst, uint8_t const *end, uint64_t value) {
+    do {
+        if ((dst == NULL) || (dst >= end)) {
+            return NULL;
+        }
+        *dst = (uint8_t)(value & 0x7FU);
+        value >>= 7;
+        if (value != 0) {
+            *dst |= 0x80U;
+        }
+        dst++;
+    } while (value != 0);
+    return dst;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static inline uint64_t _zigzag(int64_t value) {
+    return (value < 0) ? ~((uint64_t)value << 1) : ((uint64_t)value << 1);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static uint8_t *_encode_args(uint8_t *dst, uint8_t const *end, const char *format, va_list args) {
+    while ((*format != '\0') && (dst != NULL)) {
+        if (*format != '%') {
+            format++;
+            continue;
+        }
+
+        _format_spec_t spec;
+        format = _parse_spec(format + 1, &spec);
+        if (spec.width_arg == true) {
+            dst = _put_varint(dst, end, _zigzag(va_arg(args, int)));
+        }
+        if (spec.precision_arg == true) {
+            spec.precision = va_arg(args, int);
+            dst = _put_varint(dst, end, _zigzag(spec.precision));
+        }
+
+        switch (spec.conversion) {
+            case '%':
+            case '\0':
+                break;
+            case 'd':
+            case 'i': {
+                int64_t value = 0;
+                switch (spec.length) {
+                    case _LENGTH_HH:
+                        value = (signed char)va_arg(args, int);
+                        break;
+                    case _LENGTH_H:
+                        value = (short)va_arg(args, int);
+                        break;
+                    case _LENGTH_L:
+                        value = va_arg(args, long);
+                        break;
+                    case _LENGTH_LL:
+                        value = va_arg(args, long long);
+                        break;
+                    case _LENGTH_J:
+                        value = va_arg(args, intmax_t);
+                        break;
+                    case _LENGTH_Z:
+                    case _LENGTH_T:
+                        value = va_arg(args, ptrdiff_t);
+                        break;
+                    default:
+                        value = va_arg(args, int);
+                        break;
+                }
+                dst = _put_varint(dst, end, _zigzag(value));
+                break;
+            }
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X': {
+                uint64_t value = 0;
+                switch (spec.length) {
+                    case _LENGTH_HH:
+                        value = (unsigned char)va_arg(args, unsigned int);
+                        break;
+                    case _LENGTH_H:
+                        value = (unsigned short)va_arg(args, unsigned int);
+                        break;
+                    case _LENGTH_L:
+                        value = va_arg(args, unsigned long);
+                        break;
+                    case _LENGTH_LL:
+                        value = va_arg(args, unsigned long long);
+                        break;
+                    case _LENGTH_J:
+                        value = va_arg(args, uintmax_t);
+                        break;
+                    case _LENGTH_Z:
+                        value = va_arg(args, size_t);
+                        break;
+                    case _LENGTH_T:
+                        value = (uint64_t)va_arg(args, ptrdiff_t);
+                        break;
+                    default:
+                        value = va_arg(args, unsigned int);
+                        break;
+                }
+                dst = _put_varint(dst, end, value);
+                break;
+            }
+            case 'c':
+                dst = _put_varint(dst, end, (uint8_t)va_arg(args, int));
+                break;
+            case 'p':
+                dst = _put_varint(dst, end, (uintptr_t)va_arg(args, void *));
+                break;
+            case 's': {
+                const char *str = va_arg(args, const char *);
+                if (str == NULL) {
+                    str = "(null)";
+                }
+                size_t len = strlen(str);
+                if ((spec.precision >= 0) && (len > (size_t)spec.precision)) {
+                    len = (size_t)spec.precision;
+                }
+                dst = _put_varint(dst, end, len);
+                if ((dst == NULL) || (len > (size_t)(end - dst))) {
+                    return NULL;
+                }
+                memcpy(dst, str, len);
+                dst += len;
+                break;
+            }
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A': {
+                double value = (spec.length == _LENGTH_LONG_DOUBLE) ? (double)va_arg(args, long double)
+                                                                    : va_arg(args, double);
+                uint64_t bits = 0;
+                memcpy(&bits, &value, sizeof(bits));
+                if ((end - dst) < 8) {
+                    return NULL;
+                }
+                for (uint32_t i = 0; i < 8U; i++) {
+                    *dst = (uint8_t)(bits >> (8U * i));
+                    dst++;
+                }
+                break;
+            }
+            case 'n':
+                (void)va_arg(args, void *);
+                break;
+            default:
+                /* Not supported by decoder */
+                return NULL;
+        }
+    }
+    return dst;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static bool _log_encode(char *buff, log_mask_t level_mask, const char *format, va_list args) {
+    /* Payload is placed after the room for header and 2 bytes length */
+    uint8_t *payload = (uint8_t *)&buff[3];
+    uint8_t const *end = (uint8_t const *)&buff[_LINE_HEADROOM + _LINE_LENGTH];
+
+    uint8_t *dst = payload;
+    *dst = (uint8_t)level_mask;
+    dst++;
+#        if LOG_TIMESTAMP_ENABLED == 1U
+    dst = _put_varint(dst, end, _stamp_now(_ctx.io));
+#            if LOG_TIMESTAMP_FORMAT > 0U
+    dst = _put_varint(dst, end, _zigzag(_ctx.io->get_utc_time_s()));
+#            endif  // LOG_TIMESTAMP_FORMAT > 0U
+#        endif      // LOG_TIMESTAMP_ENABLED == 1U
+    dst = _put_varint(dst, end, (uintptr_t)format - (uintptr_t)__start_log_fmt);
+    dst = _encode_args(dst, end, format, args);
+    if (dst == NULL) {
+        return false;
+    }
+
+    size_t payload_size = (size_t)(dst - payload);
+    uint8_t *frame = payload - ((payload_size < 0x80U) ? 2U : 3U);
+    frame[0] = _FRAME_MAGIC | _FRAME_MESSAGE;
+    (void)_put_varint(&frame[1], payload, payload_size);
+    bool is_locked = _output_lock();
+    if (_log_write(level_mask, frame, (size_t)(dst - frame)) == true) {
+        _STATS_ADD(levels[_stats_level(level_mask)].bytes, dst - frame);
+    }
+#        if LOG_IO_FLUSH == 1U
+    _io_flush(level_mask);
+#        endif  // LOG_IO_FLUSH == 1U
+    _output_unlock(is_locked);
+
+    return true;
+}
+
+#    endif  // LOG_DEFERRED_FORMAT == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_TIMESTAMP_ENABLED == 1
+
+/* Uptime in ticks of io->get_ticks, or milliseconds of io->get_uptime_ms */
+static inline log_timestamp_t _stamp_now(log_io_t const *io) {
+#        if LOG_TIMESTAMP_TICKS == 1U
+    return io->get_ticks();
+#        else
+    return io->get_uptime_ms();
+#        endif  // LOG_TIMESTAMP_TICKS == 1U
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Converts ticks of less than a second to fraction of _STAMP_DIGITS digits */
+static inline uint32_t _stamp_fraction(uint32_t ticks) {
+#        if LOG_TIMESTAMP_TICKS == 0U
+    return ticks;
+#        elif (LOG_TIMESTAMP_TICK_HZ % 1000000UL) == 0U
+    return ticks / (uint32_t)(LOG_TIMESTAMP_TICK_HZ / 1000000UL);
+#        elif (1000000UL % LOG_TIMESTAMP_TICK_HZ) == 0U
+    return ticks * (uint32_t)(1000000UL / LOG_TIMESTAMP_TICK_HZ);
+#        else
+    return (uint32_t)(((uint64_t)ticks * 1000000U) / LOG_TIMESTAMP_TICK_HZ);
+#        endif  // LOG_TIMESTAMP_TICKS == 0U
+}
+
+/* -------------------------------------------------------------------------- */
+
+static inline int _print_uptime(char *dst, size_t size, log_timestamp_t ts) {
+    static const char _OPEN[] = _TIMESTAMP_COLOR "[";
+    char text[sizeof(_OPEN) + 20U + 9U];
+
+    /* 32 bits division is much cheaper on MCU, 64 bits one is needed only after 49 days */
+    uint64_t sec;
+    uint32_t ticks;
+    if (ts <= UINT32_MAX) {
+        sec = (uint32_t)ts / (uint32_t)_STAMP_HZ;
+        ticks = (uint32_t)ts % (uint32_t)_STAMP_HZ;
+    } else {
+        sec = (uint64_t)ts / _STAMP_HZ;
+        ticks = (uint32_t)((uint64_t)ts % _STAMP_HZ);
+    }
+
+    memcpy(text, _OPEN, sizeof(_OPEN) - 1U);
+    char *end = _put_uint(&text[sizeof(_OPEN) - 1U], sec, 4U);
+    *end++ = '.';
+    end = _put_uint(end, _stamp_fraction(ticks), _STAMP_DIGITS);
+    *end++ = ']';
+    *end++ = ' ';
+    return _put_text(dst, size, text, (size_t)(end - text));
+}
+
+/* -------------------------------------------------------------------------- */
+
+#        if LOG_TIMESTAMP_DELTA == 1U
+/*
+    Prints time since the previous line as "[+N]" in units of the last digit of the full stamp,
+    full stamp is printed each LOG_TIMESTAMP_RESYNC_LINES lines or LOG_TIMESTAMP_RESYNC_S seconds
+*/
+static int _print_stamp(char *dst, size_t size, log_timestamp_t ts, log_stamp_t *stamp) {
+    static const char _OPEN[] = _TIMESTAMP_COLOR "[+";
+    char text[sizeof(_OPEN) + 10U + 2U];
+
+    log_timestamp_t delta = (log_timestamp_t)(ts - stamp->last);
+    stamp->last = ts;
+    if ((stamp->lines == 0) ||
+        ((log_timestamp_t)(ts - stamp->sync) >= (log_timestamp_t)(LOG_TIMESTAMP_RESYNC_S * _STAMP_HZ))) {
+        stamp->sync = ts;
+        stamp->lines = LOG_TIMESTAMP_RESYNC_LINES - 1U;
+        return _print_uptime(dst, size, ts);
+    }
+    stamp->lines--;
+
+    /* Delta is less than LOG_TIMESTAMP_RESYNC_S, it's printed by 32 bits */
+    uint32_t sec = (uint32_t)delta / (uint32_t)_STAMP_HZ;
+    uint32_t fraction = _stamp_fraction((uint32_t)delta % (uint32_t)_STAMP_HZ);
+
+    memcpy(text, _OPEN, sizeof(_OPEN) - 1U);
+    char *end = _put_uint(&text[sizeof(_OPEN) - 1U], (sec * _POW10[_STAMP_DIGITS]) + fraction, 0);
+    *end++ = ']';
+    *end++ = ' ';
+    return _put_text(dst, size, text, (size_t)(end - text));
+}
+
+/* -------------------------------------------------------------------------- */
+#        endif  // LOG_TIMESTAMP_DELTA == 1U
+
+#        if LOG_TIMESTAMP_FORMAT > 0U
+/*
+    Rendered by integer arithmetic, no gmtime and snprintf, UTC has no leap seconds
+    so time of day is remainder of the day, date is got by civil from days algorithm
+*/
+static inline int _print_date_time(char *dst, size_t size, log_io_t const *io) {
+    static const char _OPEN[] = _TIMESTAMP_COLOR "[";
+    char text[sizeof(_OPEN) + 32U];
+    int64_t utc_time = (int64_t)io->get_utc_time_s();
+
+    int64_t days = utc_time / 86400;
+    int32_t seconds = (int32_t)(utc_time % 86400);
+    if (seconds < 0) {
+        seconds += 86400;
+        days--;
+    }
+
+    memcpy(text, _OPEN, sizeof(_OPEN) - 1U);
+    char *end = &text[sizeof(_OPEN) - 1U];
+
+#            if LOG_TIMESTAMP_FORMAT == 2U
+    int64_t z = days + 719468;
+    int64_t era = ((z >= 0) ? z : (z - 146096)) / 146097;
+    uint32_t doe = (uint32_t)(z - (era * 146097));
+    uint32_t yoe = (doe - (doe / 1460U) + (doe / 36524U) - (doe / 146096U)) / 365U;
+    uint32_t doy = doe - ((365U * yoe) + (yoe / 4U) - (yoe / 100U));
+    uint32_t mp = ((5U * doy) + 2U) / 153U;
+    uint32_t day = doy - (((153U * mp) + 2U) / 5U) + 1U;
+    uint32_t month = (mp < 10U) ? (mp + 3U) : (mp - 9U);
+    int64_t year = (int64_t)yoe + (era * 400) + ((month <= 2U) ? 1 : 0);
+
+    end = _put_uint(end, (uint32_t)year, 4U);
+    *end++ = '-';
+    end = _put_uint(end, month, 2U);
+    *end++ = '-';
+    end = _put_uint(end, day, 2U);
+    *end++ = ' ';
+#            else
+    (void)days;
+#            endif  // LOG_TIMESTAMP_FORMAT == 2U
+
+    end = _put_uint(end, (uint32_t)seconds / 3600U, 2U);
+    *end++ = ':';
+    end = _put_uint(end, ((uint32_t)seconds / 60U) % 60U, 2U);
+    *end++ = ':';
+    end = _put_uint(end, (uint32_t)seconds % 60U, 2U);
+    *end++ = ']';
+    *end++ = ' ';
+    return _put_text(dst, size, text, (size_t)(end - text));
 }
 #        endif  // LOG_TIMESTAMP_FORMAT > 0U
 #    endif      // LOG_TIMESTAMP_ENABLED == 1
@@ -29,6 +29,26 @@ extern "C" {
 #    define LOG_TIMESTAMP_FORMAT (0U)
 #endif  // LOG_TIMESTAMP_FORMAT
 
+#if !defined(LOG_TIMESTAMP_TICKS)
+#    define LOG_TIMESTAMP_TICKS (0U)
+#endif  // LOG_TIMESTAMP_TICKS
+
+#if !defined(LOG_TIMESTAMP_TICK_HZ)
+#    define LOG_TIMESTAMP_TICK_HZ (1000000U)
+#endif  // LOG_TIMESTAMP_TICK_HZ
+
+#if !defined(LOG_TIMESTAMP_DELTA)
+#    define LOG_TIMESTAMP_DELTA (0U)
+#endif  // LOG_TIMESTAMP_DELTA
+
+#if !defined(LOG_TIMESTAMP_RESYNC_LINES)
+#    define LOG_TIMESTAMP_RESYNC_LINES (32U)
+#endif  // LOG_TIMESTAMP_RESYNC_LINES
+
+#if !defined(LOG_TIMESTAMP_RESYNC_S)
+#    define LOG_TIMESTAMP_RESYNC_S (1U)
+#endif  // LOG_TIMESTAMP_RESYNC_S
+
 #if !defined(LOG_THREADSAFE_ENABLED)
 #    define LOG_THREADSAFE_ENABLED (0U)
 #endif
@@ -41,6 +61,208 @@ extern "C" {
 #    define LOG_ISR_QUEUE (0U)
 #endif  // LOG_ISR_QUEUE
 
+#if !defined(LOG_MODULES_ENABLED)
+#    define LOG_MODULES_ENABLED (0U)
+#endif  // LOG_MODULES_ENABLED
+
+#if !defined(LOG_MODULES_MAX)
+#    define LOG_MODULES_MAX (16U)
+#endif  // LOG_MODULES_MAX
+
+#if !defined(LOG_SINKS_ENABLED)
+#    define LOG_SINKS_ENABLED (0U)
+#endif  // LOG_SINKS_ENABLED
+
+#if !defined(LOG_SINKS_MAX)
+#    define LOG_SINKS_MAX (4U)
+#endif  // LOG_SINKS_MAX
+
+#if !defined(LOG_SINK_QUEUE_SIZE)
+#    define LOG_SINK_QUEUE_SIZE (0U)
+#endif  // LOG_SINK_QUEUE_SIZE
+
+#if !defined(LOG_RECORDER_ENABLED)
+#    define LOG_RECORDER_ENABLED (0U)
+#endif  // LOG_RECORDER_ENABLED
+
+#if !defined(LOG_RECORDER_SIZE)
+#    define LOG_RECORDER_SIZE (4096U)
+#endif  // LOG_RECORDER_SIZE
+
+#if !defined(LOG_RECORDER_ATTRIBUTE)
+#    define LOG_RECORDER_ATTRIBUTE __attribute__((section(".noinit")))
+#endif  // LOG_RECORDER_ATTRIBUTE
+
+#if !defined(LOG_COLLAPSE_REPEATS)
+#    define LOG_COLLAPSE_REPEATS (0U)
+#endif  // LOG_COLLAPSE_REPEATS
+
+#if !defined(LOG_THROTTLES_MAX)
+#    define LOG_THROTTLES_MAX (16U)
+#endif  // LOG_THROTTLES_MAX
+
+#if !defined(LOG_COMPILE_MASK)
+#    define LOG_COMPILE_MASK (0xFFU)
+#endif  // LOG_COMPILE_MASK
+
+#if !defined(LOG_FLOAT_DECIMALS)
+#    define LOG_FLOAT_DECIMALS (2U)
+#endif  // LOG_FLOAT_DECIMALS
+
+#if !defined(LOG_HEXDUMP_ROW_LENGTH)
+#    define LOG_HEXDUMP_ROW_LENGTH (16U)
+#endif  // LOG_HEXDUMP_ROW_LENGTH
+
+#if !defined(LOG_ISR_QUEUE_SIZE)
+#    define LOG_ISR_QUEUE_SIZE (512U)
+#endif  // LOG_ISR_QUEUE_SIZE
+
+#if !defined(LOG_ISR_FLUSH_BUDGET)
+#    define LOG_ISR_FLUSH_BUDGET (8U)
+#endif  // LOG_ISR_FLUSH_BUDGET
+
+#if !defined(LOG_IO_WRITEV)
+#    define LOG_IO_WRITEV (0U)
+#endif  // LOG_IO_WRITEV
+
+#if !defined(LOG_IO_FLUSH)
+#    define LOG_IO_FLUSH (0U)
+#endif  // LOG_IO_FLUSH
+
+#if !defined(LOG_IO_FLUSH_MASK)
+#    define LOG_IO_FLUSH_MASK (LOG_MASK_ERROR)
+#endif  // LOG_IO_FLUSH_MASK
+
+#if !defined(LOG_IO_RESERVE)
+#    define LOG_IO_RESERVE (0U)
+#endif  // LOG_IO_RESERVE
+
+#define LOG_ASYNC_DROP      (0U)
+#define LOG_ASYNC_OVERWRITE (1U)
+#define LOG_ASYNC_BLOCK     (2U)
+
+#if !defined(LOG_ASYNC_ENABLED)
+#    define LOG_ASYNC_ENABLED (0U)
+#endif  // LOG_ASYNC_ENABLED
+
+#if !defined(LOG_ASYNC_BUFFER_SIZE)
+#    define LOG_ASYNC_BUFFER_SIZE (1024U)
+#endif  // LOG_ASYNC_BUFFER_SIZE
+
+#if !defined(LOG_ASYNC_POLICY)
+#    define LOG_ASYNC_POLICY LOG_ASYNC_DROP
+#endif  // LOG_ASYNC_POLICY
+
+#if !defined(LOG_IO_WRITE_ASYNC)
+#    define LOG_IO_WRITE_ASYNC (0U)
+#endif  // LOG_IO_WRITE_ASYNC
+
+#if !defined(LOG_IO_BUFFERS)
+#    define LOG_IO_BUFFERS (2U)
+#endif  // LOG_IO_BUFFERS
+
+#if !defined(LOG_IO_BUFFER_SIZE)
+#    define LOG_IO_BUFFER_SIZE (512U)
+#endif  // LOG_IO_BUFFER_SIZE
+
+#if !defined(LOG_IO_BUFFER_POLICY)
+#    define LOG_IO_BUFFER_POLICY LOG_ASYNC_DROP
+#endif  // LOG_IO_BUFFER_POLICY
+
+#if !defined(LOG_BUILTIN_PRINTF)
+#    define LOG_BUILTIN_PRINTF (0U)
+#endif  // LOG_BUILTIN_PRINTF
+
+#if !defined(LOG_INSTANCES_ENABLED)
+#    define LOG_INSTANCES_ENABLED (0U)
+#endif  // LOG_INSTANCES_ENABLED
+
+#if !defined(LOG_DEFERRED_FORMAT)
+#    define LOG_DEFERRED_FORMAT (0U)
+#endif  // LOG_DEFERRED_FORMAT
+
+#if !defined(LOG_DEFERRED_DECODER)
+#    define LOG_DEFERRED_DECODER (0U)
+#endif  // LOG_DEFERRED_DECODER
+
+#if !defined(LOG_PARALLEL_FORMAT)
+#    define LOG_PARALLEL_FORMAT (0U)
+#endif  // LOG_PARALLEL_FORMAT
+
+#if !defined(LOG_IO_ATOMIC)
+#    define LOG_IO_ATOMIC (0U)
+#endif  // LOG_IO_ATOMIC
+
+#if !defined(LOG_STATS_ENABLED)
+#    define LOG_STATS_ENABLED (0U)
+#endif  // LOG_STATS_ENABLED
+
+#if !defined(LOG_BACKPRESSURE_ENABLED)
+#    define LOG_BACKPRESSURE_ENABLED (0U)
+#endif  // LOG_BACKPRESSURE_ENABLED
+
+#if !defined(LOG_BACKPRESSURE_MASK)
+#    define LOG_BACKPRESSURE_MASK (LOG_MASK_ERROR | LOG_MASK_WARNING)
+#endif  // LOG_BACKPRESSURE_MASK
+
+#if !defined(LOG_BACKPRESSURE_RESERVE)
+#    define LOG_BACKPRESSURE_RESERVE (25U)
+#endif  // LOG_BACKPRESSURE_RESERVE
+
+#if !defined(LOG_TIMERS_ENABLED)
+#    define LOG_TIMERS_ENABLED (0U)
+#endif  // LOG_TIMERS_ENABLED
+
+#if !defined(LOG_TIMERS_MAX)
+#    define LOG_TIMERS_MAX (16U)
+#endif  // LOG_TIMERS_MAX
+
+#if !defined(LOG_TIMER_BUCKETS)
+#    define LOG_TIMER_BUCKETS (16U)
+#endif  // LOG_TIMER_BUCKETS
+
+#if !defined(LOG_COMPRESS_ENABLED)
+#    define LOG_COMPRESS_ENABLED (0U)
+#endif  // LOG_COMPRESS_ENABLED
+
+#if !defined(LOG_COMPRESS_WINDOW)
+#    define LOG_COMPRESS_WINDOW (1024U)
+#endif  // LOG_COMPRESS_WINDOW
+
+#if !defined(LOG_COMPRESS_SYNC_INTERVAL)
+#    define LOG_COMPRESS_SYNC_INTERVAL (4096U)
+#endif  // LOG_COMPRESS_SYNC_INTERVAL
+
+#if !defined(LOG_COMPRESS_DICTIONARY)
+#    define LOG_COMPRESS_DICTIONARY                                                                                    \
+        LOG_COLOR(LOG_COLOR_WHITE) "[" LOG_COLOR(LOG_COLOR_GREEN) LOG_COLOR(LOG_COLOR_YELLOW) LOG_COLOR(LOG_COLOR_RED) \
+            LOG_COLOR(LOG_COLOR_BLUE) "] " LOG_ENDLINE
+#endif  // LOG_COMPRESS_DICTIONARY
+
+#if !defined(LOG_COMPRESS_DECODER)
+#    define LOG_COMPRESS_DECODER (0U)
+#endif  // LOG_COMPRESS_DECODER
+
+#if LOG_COMPRESS_DECODER == 1U
+/* Host side decompressor writes original stream, it doesn't compress its own output */
+#    undef LOG_COMPRESS_ENABLED
+#    define LOG_COMPRESS_ENABLED (0U)
+#endif  // LOG_COMPRESS_DECODER == 1U
+
+#if LOG_DEFERRED_DECODER == 1U
+/* Host side decoder is built as a text logger, it turns frames back into text */
+#    undef LOG_DEFERRED_FORMAT
+#    define LOG_DEFERRED_FORMAT (0U)
+#endif  // LOG_DEFERRED_DECODER == 1U
+
+#if !defined(LOG_MODULE_NAME)
+#    if defined(__FILE_NAME__)
+#        define LOG_MODULE_NAME __FILE_NAME__
+#    else
+#        define LOG_MODULE_NAME __FILE__
+#    endif  // __FILE_NAME__
+#endif      // LOG_MODULE_NAME
+
 #if !defined(LOG_FILE_TAG)
 #    if defined(__FILE_NAME__)
 #        define LOG_FILE_TAG "[" __FILE_NAME__ "] "
@@ -69,20 +291,100 @@ typedef enum {
     LOGGER_RESULT_ERROR,
 } log_result_t;
 
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+} log_iovec_t;
+
 #if LOG_TIMESTAMP_64BIT == (0U)
 typedef uint32_t log_timestamp_t;
 #else
 typedef uint64_t log_timestamp_t;
 #endif
 
+#if LOG_TIMESTAMP_DELTA == 1U
+/* Do not use it in your code, state of delta timestamps, zero means the next stamp is full */
+typedef struct {
+    log_timestamp_t last;
+    log_timestamp_t sync;
+    uint32_t lines;
+} log_stamp_t;
+#endif  // LOG_TIMESTAMP_DELTA == 1U
+
 /* ===== LOG MACROS ========================================================= */
 
 #if LOG_ENABLED == 1U
-#    define LOG(...)         log_it(__VA_ARGS__)
-#    define LOG_ARRAY(...)   log_array(__VA_ARGS__)
-#    define LOG_ARRAY_F(...) log_array_float(__VA_ARGS__)
-#    define LOG_RAW(...)     log_raw(LOG_MASK_RAW, __VA_ARGS__)
+/*
+    Levels out of LOG_COMPILE_MASK are removed by compiler, others are checked before
+    arguments are evaluated, so filtered out message costs one load and compare
+*/
+#    define LOG_IS_ENABLED(LEVEL) ((((LEVEL) & LOG_COMPILE_MASK) != 0U) && (((LEVEL) & _log_mask) != 0U))
+#    if LOG_STATS_ENABLED == 1U
+/* Calls filtered at runtime are counted, levels out of LOG_COMPILE_MASK are not */
+#        define _LOG_FILTERED(LEVEL)                           \
+            do {                                               \
+                if (((LEVEL) & LOG_COMPILE_MASK) != 0U) {      \
+                    _log_stats_filtered((log_mask_t)(LEVEL)); \
+                }                                              \
+            } while (0)
+#    else
+#        define _LOG_FILTERED(LEVEL) \
+            do {                     \
+            } while (0)
+#    endif  // LOG_STATS_ENABLED == 1U
+#    if LOG_MODULES_ENABLED == 1U
+/* Each call site resolves mask of its module once, later check is one load and compare */
+#        define _LOG_IF_ENABLED(LEVEL, CALL)                           \
+            do {                                                       \
+                if (LOG_IS_ENABLED(LEVEL)) {                           \
+                    static log_mask_t const *_log_site = NULL;         \
+                    if (_log_site == NULL) {                           \
+                        _log_site = _log_module_mask(LOG_MODULE_NAME); \
+                    }                                                  \
+                    if (((LEVEL) & *_log_site) != 0U) {                \
+                        CALL;                                          \
+                    } else {                                           \
+                        _LOG_FILTERED(LEVEL);                          \
+                    }                                                  \
+                } else {                                               \
+                    _LOG_FILTERED(LEVEL);                              \
+                }                                                      \
+            } while (0)
+#    else
+#        define _LOG_IF_ENABLED(LEVEL, CALL) \
+            do {                             \
+                if (LOG_IS_ENABLED(LEVEL)) { \
+                    CALL;                    \
+                } else {                     \
+                    _LOG_FILTERED(LEVEL);    \
+                }                            \
+            } while (0)
+#    endif  // LOG_MODULES_ENABLED == 1U
+#endif      // LOG_ENABLED == 1U
+
+#if (LOG_ENABLED == 1U) && (LOG_DEFERRED_FORMAT == 1U)
+/* Format strings are collected in "log_fmt" section, only offset in the section is sent */
+#    define _LOG_DEFERRED(LEVEL, FORMAT, ...)                                          \
+        do {                                                                           \
+            static const char _log_fmt[] __attribute__((section("log_fmt"))) = FORMAT; \
+            if (0) {                                                                   \
+                _log_check_format(FORMAT, ##__VA_ARGS__);                              \
+            }                                                                          \
+            log_deferred(LEVEL, _log_fmt, ##__VA_ARGS__);                              \
+        } while (0)
+#    define LOG(LEVEL, FORMAT, ...) _LOG_IF_ENABLED(LEVEL, _LOG_DEFERRED(LEVEL, FORMAT, ##__VA_ARGS__))
+#    define LOG_ARRAY(LEVEL, ...)   _LOG_IF_ENABLED(LEVEL, log_array(LEVEL, __VA_ARGS__))
+#    define LOG_ARRAY_F(LEVEL, ...) _LOG_IF_ENABLED(LEVEL, log_array_float(LEVEL, __VA_ARGS__))
+#    define LOG_HEXDUMP(LEVEL, ...) _LOG_IF_ENABLED(LEVEL, log_hexdump(LEVEL, __VA_ARGS__))
+#    define LOG_RAW(...)            _LOG_IF_ENABLED(LOG_MASK_RAW, log_raw(LOG_MASK_RAW, __VA_ARGS__))
+#elif LOG_ENABLED == 1U
+#    define LOG(LEVEL, ...)         _LOG_IF_ENABLED(LEVEL, log_it(LEVEL, __VA_ARGS__))
+#    define LOG_ARRAY(LEVEL, ...)   _LOG_IF_ENABLED(LEVEL, log_array(LEVEL, __VA_ARGS__))
+#    define LOG_ARRAY_F(LEVEL, ...) _LOG_IF_ENABLED(LEVEL, log_array_float(LEVEL, __VA_ARGS__))
+#    define LOG_HEXDUMP(LEVEL, ...) _LOG_IF_ENABLED(LEVEL, log_hexdump(LEVEL, __VA_ARGS__))
+#    define LOG_RAW(...)            _LOG_IF_ENABLED(LOG_MASK_RAW, log_raw(LOG_MASK_RAW, __VA_ARGS__))
 #else /* LOG_ENABLED == 1 */
+#    define LOG_IS_ENABLED(LEVEL) (0)
 #    define LOG(...)                                            \
         do {                                                    \
             /* empty macro to avoid static analyzer warnings */ \
@@ -92,6 +394,10 @@ typedef uint64_t log_timestamp_t;
             /* empty macro to avoid static analyzer warnings */ \
         } while (0)
 #    define LOG_ARRAY_F(...)                                    \
+        do {                                                    \
+            /* empty macro to avoid static analyzer warnings */ \
+        } while (0)
+#    define LOG_HEXDUMP(...)                                    \
         do {                                                    \
             /* empty macro to avoid static analyzer warnings */ \
         } while (0)
@@ -122,16 +428,132 @@ typedef uint64_t log_timestamp_t;
 #define LOG_WARNING(...) LOG(LOG_MASK_WARNING, LOG_COLOR(LOG_COLOR_YELLOW) LOG_FILE_TAG __VA_ARGS__)
 #define LOG_ERROR(...)   LOG(LOG_MASK_ERROR, LOG_COLOR(LOG_COLOR_RED) LOG_FILE_TAG __VA_ARGS__)
 
+#if (LOG_ENABLED == 1U) && (LOG_INSTANCES_ENABLED == 1U)
+/* Same as LOG for logger instance, its mask is checked before arguments are evaluated */
+#    define LOG_INSTANCE(INSTANCE, LEVEL, ...)                                                   \
+        do {                                                                                    \
+            if ((((LEVEL) & LOG_COMPILE_MASK) != 0U) && (((LEVEL) & (INSTANCE)->mask) != 0U)) { \
+                log_instance_it((INSTANCE), (LEVEL), __VA_ARGS__);                              \
+            } else {                                                                            \
+                _LOG_FILTERED(LEVEL);                                                           \
+            }                                                                                   \
+        } while (0)
+#    define LOG_INSTANCE_RAW(INSTANCE, ...)                                                               \
+        do {                                                                                              \
+            if (((LOG_MASK_RAW & LOG_COMPILE_MASK) != 0U) && ((LOG_MASK_RAW & (INSTANCE)->mask) != 0U)) { \
+                log_instance_raw((INSTANCE), LOG_MASK_RAW, __VA_ARGS__);                                  \
+            } else {                                                                                      \
+                _LOG_FILTERED(LOG_MASK_RAW);                                                              \
+            }                                                                                             \
+        } while (0)
+#else
+#    define LOG_INSTANCE(...)                                   \
+        do {                                                    \
+            /* empty macro to avoid static analyzer warnings */ \
+        } while (0)
+#    define LOG_INSTANCE_RAW(...)                               \
+        do {                                                    \
+            /* empty macro to avoid static analyzer warnings */ \
+        } while (0)
+#endif  // (LOG_ENABLED == 1U) && (LOG_INSTANCES_ENABLED == 1U)
+
+#define LOG_INSTANCE_DEBUG(INSTANCE, ...) \
+    LOG_INSTANCE(INSTANCE, LOG_MASK_DEBUG, LOG_COLOR(LOG_COLOR_WHITE) LOG_FILE_TAG __VA_ARGS__)
+#define LOG_INSTANCE_INFO(INSTANCE, ...) \
+    LOG_INSTANCE(INSTANCE, LOG_MASK_INFO, LOG_COLOR(LOG_COLOR_GREEN) LOG_FILE_TAG __VA_ARGS__)
+#define LOG_INSTANCE_WARNING(INSTANCE, ...) \
+    LOG_INSTANCE(INSTANCE, LOG_MASK_WARNING, LOG_COLOR(LOG_COLOR_YELLOW) LOG_FILE_TAG __VA_ARGS__)
+#define LOG_INSTANCE_ERROR(INSTANCE, ...) \
+    LOG_INSTANCE(INSTANCE, LOG_MASK_ERROR, LOG_COLOR(LOG_COLOR_RED) LOG_FILE_TAG __VA_ARGS__)
+
 #define LOG_DEBUG_ARRAY(...)       LOG_ARRAY(LOG_MASK_DEBUG, LOG_COLOR(LOG_COLOR_WHITE) LOG_FILE_TAG __VA_ARGS__)
 #define LOG_DEBUG_ARRAY_RED(...)   LOG_ARRAY(LOG_MASK_DEBUG, LOG_COLOR(LOG_COLOR_RED) LOG_FILE_TAG __VA_ARGS__)
 #define LOG_DEBUG_ARRAY_GREEN(...) LOG_ARRAY(LOG_MASK_DEBUG, LOG_COLOR(LOG_COLOR_GREEN) LOG_FILE_TAG __VA_ARGS__)
 #define LOG_DEBUG_ARRAY_BLUE(...)  LOG_ARRAY(LOG_MASK_DEBUG, LOG_COLOR(LOG_COLOR_BLUE) LOG_FILE_TAG __VA_ARGS__)
 
+#define LOG_DEBUG_HEXDUMP(...) LOG_HEXDUMP(LOG_MASK_DEBUG, LOG_COLOR(LOG_COLOR_WHITE) LOG_FILE_TAG __VA_ARGS__)
+
 #define LOG_DEBUG_ARRAY_F(...)       LOG_ARRAY_F(LOG_MASK_DEBUG, LOG_COLOR(LOG_COLOR_WHITE) LOG_FILE_TAG __VA_ARGS__)
 #define LOG_DEBUG_ARRAY_RED_F(...)   LOG_ARRAY_F(LOG_MASK_DEBUG, LOG_COLOR(LOG_COLOR_RED) LOG_FILE_TAG __VA_ARGS__)
 #define LOG_DEBUG_ARRAY_GREEN_F(...) LOG_ARRAY_F(LOG_MASK_DEBUG, LOG_COLOR(LOG_COLOR_GREEN) LOG_FILE_TAG __VA_ARGS__)
 #define LOG_DEBUG_ARRAY_BLUE_F(...)  LOG_ARRAY_F(LOG_MASK_DEBUG, LOG_COLOR(LOG_COLOR_BLUE) LOG_FILE_TAG __VA_ARGS__)
 
+#if LOG_ENABLED == 1U
+/*
+    Rate limits of call site, LOG statement is wrapped and skipped before formatting,
+    e.g. LOG_EVERY_MS(1000U, LOG_MASK_ERROR, LOG_ERROR("Fault %d", code));
+    LOG_EVERY_N with N of 0 lets every statement through, callers of the same site may run at the same time.
+    LOG_EVERY_MS takes level of the wrapped statement, it's skipped without reading time when level is disabled.
+    Number of skipped messages is written at that level when the next one is let through, or after the period
+    by the next LOG call of any site, log_process() or log_flush_isr_queue() when the site stays silent
+*/
+#    define LOG_ONCE(...)                   \
+        do {                                \
+            static uint32_t _log_done = 0;  \
+            if (_log_once(&_log_done)) {    \
+                __VA_ARGS__;                \
+            }                               \
+        } while (0)
+#    define LOG_EVERY_N(N, ...)                             \
+        do {                                                \
+            static uint32_t _log_count = 0;                 \
+            if (_log_every_n(&_log_count, (uint32_t)(N))) { \
+                __VA_ARGS__;                                \
+            }                                               \
+        } while (0)
+#    if LOG_TIMESTAMP_ENABLED == 1U
+#        define LOG_EVERY_MS(MS, LEVEL, ...)                                              \
+            do {                                                                          \
+                static log_throttle_t *_log_throttle = NULL;                              \
+                if (LOG_IS_ENABLED(LEVEL) &&                                              \
+                    _log_every_ms(&_log_throttle, (log_mask_t)(LEVEL), (uint32_t)(MS))) { \
+                    __VA_ARGS__;                                                          \
+                }                                                                         \
+            } while (0)
+#    endif  // LOG_TIMESTAMP_ENABLED == 1U
+#else
+#    define LOG_ONCE(...)                                       \
+        do {                                                    \
+            /* empty macro to avoid static analyzer warnings */ \
+        } while (0)
+#    define LOG_EVERY_N(...)                                    \
+        do {                                                    \
+            /* empty macro to avoid static analyzer warnings */ \
+        } while (0)
+#    define LOG_EVERY_MS(...)                                   \
+        do {                                                    \
+            /* empty macro to avoid static analyzer warnings */ \
+        } while (0)
+#endif  // LOG_ENABLED == 1U
+
+#if (LOG_ENABLED == 1U) && (LOG_TIMERS_ENABLED == 1U)
+/*
+    Time of code is added to the timer of NAME, nothing is written until log_dump_timers(),
+    e.g. LOG_TIME_BEGIN(adc); adc_read(); LOG_TIME_END(adc);
+    LOG_TIME_BEGIN is a declaration, LOG_TIME_END must be in the same block scope after it.
+    LOG_SCOPE_TIMER measures till the end of the block, it needs GCC or Clang
+*/
+#    if defined(LOG_TIMER_CLOCK)
+#        define _LOG_TIMER_NOW() ((uint32_t)LOG_TIMER_CLOCK())
+#    else
+#        define _LOG_TIMER_NOW() _log_timer_now()
+#    endif  // LOG_TIMER_CLOCK
+#    define LOG_TIME_BEGIN(NAME)                     \
+        static log_timer_t *_log_timer_##NAME = NULL; \
+        log_scope_t _log_scope_##NAME = { &_log_timer_##NAME, #NAME, _LOG_TIMER_NOW() }
+#    define LOG_TIME_END(NAME) _log_scope_end(&_log_scope_##NAME)
+#    define LOG_SCOPE_TIMER(NAME)                                                    \
+        static log_timer_t *_log_timer_##NAME = NULL;                                 \
+        log_scope_t _log_scope_##NAME __attribute__((cleanup(_log_scope_end))) = { \
+            &_log_timer_##NAME, #NAME, _LOG_TIMER_NOW()                               \
+        }
+#else
+/* Declarations as of enabled timers, so BEGIN and END of different blocks don't compile in both builds */
+#    define LOG_TIME_BEGIN(NAME)  enum { _log_scope_##NAME = 0 }
+#    define LOG_TIME_END(NAME)    ((void)_log_scope_##NAME)
+#    define LOG_SCOPE_TIMER(NAME) enum { _log_scope_##NAME = 0 }
+#endif  // (LOG_ENABLED == 1U) && (LOG_TIMERS_ENABLED == 1U)
+
 #if LOG_ENABLED == 1U
 typedef struct {
     void (*write)(const uint8_t *data, size_t size);
@@ -142,16 +564,137 @@ typedef struct {
 #    if LOG_TIMESTAMP_ENABLED == 1U
     log_timestamp_t (*get_uptime_ms)(void);
 #    endif  // LOG_TIMESTAMP_ENABLED == 1U
+#    if LOG_TIMESTAMP_TICKS == 1U
+    /* Free running 64 bits counter of LOG_TIMESTAMP_TICK_HZ, e.g. microseconds timer or DWT->CYCCNT with its overflows */
+    log_timestamp_t (*get_ticks)(void);
+#    endif  // LOG_TIMESTAMP_TICKS == 1U
 #    if LOG_TIMESTAMP_FORMAT > 0U
     time_t (*get_utc_time_s)(void);
 #    endif  // LOG_TIMESTAMP_FORMAT > 0U
 #    if LOG_ISR_QUEUE == 1U
     bool (*is_isr)(void);
 #    endif  // LOG_ISR_QUEUE == 1U
+#    if LOG_IO_WRITEV == 1U
+    void (*writev)(const log_iovec_t *iov, size_t count);
+#    endif  // LOG_IO_WRITEV == 1U
+#    if LOG_IO_FLUSH == 1U
+    void (*flush)(void);
+#    endif  // LOG_IO_FLUSH == 1U
+#    if LOG_IO_RESERVE == 1U
+    /* Returns sink memory for the line of 'size' bytes, NULL - line is copied by io->write */
+    uint8_t *(*reserve)(size_t size);
+    /* Passes first 'size' bytes of reserved memory to the sink, 0 cancels reservation */
+    void (*commit)(size_t size);
+#    endif  // LOG_IO_RESERVE == 1U
+#    if LOG_IO_WRITE_ASYNC == 1U
+    /* Starts transfer and returns, data is valid until log_write_complete(), io->write isn't used */
+    void (*write_async)(const uint8_t *data, size_t size);
+#        if LOG_IO_BUFFER_POLICY == LOG_ASYNC_BLOCK
+    /* Called while all buffers are busy, e.g. takes semaphore given after log_write_complete(), may return early */
+    void (*wait)(void);
+#        endif  // LOG_IO_BUFFER_POLICY == LOG_ASYNC_BLOCK
+#    endif  // LOG_IO_WRITE_ASYNC == 1U
 } log_io_t;
 
 log_result_t log_init(const log_mask_t level, log_io_t const *io);
 
+#    if LOG_INSTANCES_ENABLED == 1U
+/*
+    Independent logger with its own io, mask, lock of io and line buffer, LOG_INSTANCE_* macros
+    write to it. Line is formatted in 'buff' of 'size' bytes including timestamps by the same code
+    as lines of log_it(), so message is limited by the buffer instead of LOG_MAX_MESSAGE_LENGTH,
+    with LOG_BUILTIN_PRINTF longer line is written in parts. Statistics count it as line of its level.
+    Line is written by io->write, sinks, queues, compression and other options of log_init() logger
+    are not applied
+*/
+typedef struct {
+    log_io_t const *io;
+    char *buff;
+    size_t size;
+    /* Runtime mask, it can be changed at any time */
+    log_mask_t mask;
+#        if LOG_TIMESTAMP_DELTA == 1U
+    log_stamp_t stamp;
+#        endif  // LOG_TIMESTAMP_DELTA == 1U
+} log_instance_t;
+
+log_result_t log_instance_init(log_instance_t *instance, const log_mask_t level, log_io_t const *io, char *buff,
+                               size_t size);
+#    endif  // LOG_INSTANCES_ENABLED == 1U
+
+#    if LOG_IO_WRITE_ASYNC == 1U
+/* Called by driver when transfer of io->write_async is done, usually from TX complete interrupt */
+void log_write_complete(void);
+#    endif  // LOG_IO_WRITE_ASYNC == 1U
+
+/* Do not use it in your code, it is runtime mask set by log_init(), with modules it includes all of them */
+extern log_mask_t _log_mask;
+
+/* Do not use it in your code, LOG_EVERY_N and LOG_ONCE call them, site counters are updated atomically */
+bool _log_every_n(uint32_t *count, uint32_t period);
+bool _log_once(uint32_t *done);
+
+#    if LOG_TIMESTAMP_ENABLED == 1U
+/* State of LOG_EVERY_MS call site, it is kept in log_.c */
+typedef struct log_throttle_s log_throttle_t;
+
+/* Do not use it in your code, LOG_EVERY_MS calls it */
+bool _log_every_ms(log_throttle_t **site, log_mask_t level, uint32_t period_ms);
+#    endif  // LOG_TIMESTAMP_ENABLED == 1U
+
+#    if LOG_MODULES_ENABLED == 1U
+/*
+    Overrides mask of module, name is LOG_MODULE_NAME of its files, by default it is file name like "uart.c",
+    name must stay valid, modules which were not set follow mask of log_init(),
+    returns LOGGER_RESULT_ERROR before log_init() or when the table of modules is full
+*/
+log_result_t log_set_module_mask(const char *name, const log_mask_t level);
+
+/* Do not use it in your code, LOG macros call it once per call site */
+log_mask_t const *_log_module_mask(const char *name);
+#    endif  // LOG_MODULES_ENABLED == 1U
+
+#    if LOG_SINKS_ENABLED == 1U
+typedef enum {
+    LOG_SINK_TIMESTAMP_NONE,
+    LOG_SINK_TIMESTAMP_UPTIME,
+    /* As configured by LOG_TIMESTAMP_FORMAT */
+    LOG_SINK_TIMESTAMP_FULL,
+} log_sink_timestamp_t;
+
+typedef struct {
+    void (*write)(const uint8_t *data, size_t size);
+    log_mask_t mask;
+    log_sink_timestamp_t timestamp;
+    /* Keep LOG_COLOR escapes, disable it for files and other non-terminal sinks */
+    bool is_color;
+    /* Lines are put to queue of LOG_SINK_QUEUE_SIZE and written by log_process(), so slow sink doesn't delay others */
+    bool is_queued;
+} log_sink_t;
+
+/*
+    Adds sink which gets lines of its mask together with io->write, sink is copied,
+    call it after log_init(), mask of log_init() becomes mask of io->write only.
+    Sink without queue is written by LOG caller, interrupts skip it with LOG_ISR_QUEUE
+*/
+log_result_t log_add_sink(log_sink_t const *sink);
+#    endif  // LOG_SINKS_ENABLED == 1U
+
+#    if LOG_RECORDER_ENABLED == 1U
+/*
+    Sets levels kept by flight recorder, they are formatted even if io->write doesn't get them,
+    mask of log_init() becomes mask of io->write only, all levels are recorded by default
+*/
+log_result_t log_recorder_set_mask(const log_mask_t level_mask);
+
+/*
+    Writes lines kept by flight recorder to io->write, call it after log_init() on start up
+    to see what happened before reset, returns error if buffer was corrupted, it is cleared then.
+    Lines with bad checksum are skipped and counted, error is returned too
+*/
+log_result_t log_recorder_dump(void);
+#    endif  // LOG_RECORDER_ENABLED == 1U
+
 #    if defined(__GNUC__)
 /* Enable format checking by GCC compiler */
 #        define __PRINTF_FORMAT __attribute__((format(printf, 2, 3)))
@@ -164,8 +707,124 @@ void log_it(const log_mask_t level, const char *format, ...) __PRINTF_FORMAT;
 void log_raw(const log_mask_t level, const char *format, ...) __PRINTF_FORMAT;
 void log_array(const log_mask_t level, const char *message, const void *array, size_t size);
 void log_array_float(const log_mask_t level, const char *message, const float *array, size_t size);
+/* Canonical dump, LOG_HEXDUMP_ROW_LENGTH bytes per row with offset and ASCII column */
+void log_hexdump(const log_mask_t level, const char *message, const void *array, size_t size);
+/* Do not use it in your code, C++ front-end log_.hpp writes message formatted by itself, it's truncated as log_it() */
+void _log_text(const log_mask_t level, const char *text, size_t size, bool add_formating);
+
+#    if LOG_INSTANCES_ENABLED == 1U
+#        if defined(__GNUC__)
+#            define __PRINTF_FORMAT_INSTANCE __attribute__((format(printf, 3, 4)))
+#        else
+#            define __PRINTF_FORMAT_INSTANCE
+#        endif
+
+/* Do not use it in your code, better use defines like LOG_INSTANCE_INFO */
+void log_instance_it(log_instance_t *instance, const log_mask_t level, const char *format, ...)
+    __PRINTF_FORMAT_INSTANCE;
+void log_instance_raw(log_instance_t *instance, const log_mask_t level, const char *format, ...)
+    __PRINTF_FORMAT_INSTANCE;
+#    endif  // LOG_INSTANCES_ENABLED == 1U
+/* Do not use it in your code, "%.<decimals>f" of log_array_float() without libc, decimals are limited by 9 */
+int _log_ftoa(char *dst, size_t size, double value, uint32_t decimals);
+
+/* Number of level bits, per level counters of statistics and backpressure */
+#    define LOG_STATS_LEVELS (8U)
+
+#    if LOG_STATS_ENABLED == 1U
+
+/* Counters wrap around, read them with reset periodically */
+typedef struct {
+    uint32_t emitted;
+    uint32_t filtered;
+    uint32_t bytes;
+    uint32_t truncated;
+} log_level_stats_t;
+
+typedef struct {
+    /* Index is number of the level bit, e.g. 2 for LOG_MASK_ERROR */
+    log_level_stats_t levels[LOG_STATS_LEVELS];
+    uint32_t snprintf_errors;
+    /* Messages which didn't fit asynchronous ring, interrupt queue or sink queues */
+    uint32_t dropped;
+    /* Time in units of LOG_STATS_CLOCK, or milliseconds of io->get_uptime_ms */
+    uint32_t write_time;
+    uint32_t lock_time;
+} log_stats_t;
+
+/* Copies counters, they are cleared by the same call if is_reset is set */
+log_result_t log_get_stats(log_stats_t *stats, bool is_reset);
+/* Do not use it in your code, LOG macros count filtered calls by it */
+void _log_stats_filtered(log_mask_t level_mask);
+#    endif  // LOG_STATS_ENABLED == 1U
+
+#    if LOG_TIMERS_ENABLED == 1U
+/* Counters of one timer, they are kept in log_.c */
+typedef struct log_timer_s log_timer_t;
+
+/* Do not use it in your code, measurement started by LOG_TIME_BEGIN or LOG_SCOPE_TIMER */
+typedef struct {
+    log_timer_t **site;
+    const char *name;
+    uint32_t start;
+} log_scope_t;
+
+/*
+    Writes count, min, mean, max and histogram of every timer by log_it() of 'level', bucket "<N" counts times
+    below N and not below previous one. Time is in units of LOG_TIMER_CLOCK, io->get_ticks or milliseconds.
+    Counters wrap around, call it with reset periodically,
+    e.g. LOG_EVERY_MS(10000U, LOG_MASK_INFO, log_dump_timers(LOG_MASK_INFO, true));
+*/
+void log_dump_timers(const log_mask_t level, bool is_reset);
+/* Do not use it in your code, LOG_TIME_END and LOG_SCOPE_TIMER call it */
+void _log_scope_end(log_scope_t *scope);
+uint32_t _log_timer_now(void);
+#    endif  // LOG_TIMERS_ENABLED == 1U
+
+#    if (LOG_ASYNC_ENABLED == 1U) || ((LOG_SINKS_ENABLED == 1U) && (LOG_SINK_QUEUE_SIZE > 0U))
+/*
+    Writes messages collected by LOG calls to io->write and queued sinks, call it from
+    dedicated thread or idle loop, only one caller at a time is allowed.
+    Returns number of written messages
+*/
+size_t log_process(void);
+#    endif  // (LOG_ASYNC_ENABLED == 1U) || ((LOG_SINKS_ENABLED == 1U) && (LOG_SINK_QUEUE_SIZE > 0U))
+
+#    if LOG_DEFERRED_FORMAT == 1U
+/* Do not use it in your code, LOG macros place format into "log_fmt" section before call it */
+void log_deferred(const log_mask_t level, const char *format, ...);
+
+#        if defined(__GNUC__)
+__attribute__((format(printf, 1, 2)))
+#        endif
+static inline void _log_check_format(const char *format, ...) {
+    (void)format;
+}
+#    endif  // LOG_DEFERRED_FORMAT == 1U
+
+#    if LOG_DEFERRED_DECODER == 1U
+/*
+    Turns frames produced by log_deferred() back into text and prints them by log_it(),
+    formats - content of "log_fmt" section of the firmware,
+    returns number of consumed bytes, incomplete frame in the tail is not consumed
+*/
+size_t log_deferred_decode(const char *formats, size_t formats_size, const uint8_t *data, size_t size);
+#    endif  // LOG_DEFERRED_DECODER == 1U
+
+#    if LOG_COMPRESS_DECODER == 1U
+/*
+    Turns blocks of LOG_COMPRESS_ENABLED stream back into original bytes and writes them by io->write,
+    decoder joins the stream by the next reset block, damaged blocks are skipped until the next one.
+    Returns number of consumed bytes, incomplete block in the tail is not consumed
+*/
+size_t log_uncompress(const uint8_t *data, size_t size);
+#    endif  // LOG_COMPRESS_DECODER == 1U
 
 #    if LOG_ISR_QUEUE == 1U
+/*
+    Writes up to LOG_ISR_FLUSH_BUDGET messages logged from interrupts, call it from idle loop,
+    queue is also flushed by next LOG call outside of interrupt
+*/
 void log_flush_isr_queue(void);
 #    endif  // LOG_ISR_QUEUE == 1U
 
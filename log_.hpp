@@ -0,0 +1,440 @@
+#ifndef __LOG_HPP__
+#define __LOG_HPP__
+
+/*
+    Optional C++17 front-end, include it instead of log_.h in C++ sources.
+    LOG macros keep their names, format string is parsed by compiler: wrong count or type
+    of arguments doesn't compile, each specifier is turned into encoder of its argument type
+    and text between specifiers, color and LOG_FILE_TAG included, is copied as one literal.
+    Message is passed to the same log_io_t by _log_text(), there is no vsnprintf and varargs.
+    Supported conversions are d i u x X o c s p f F and %%, with flags - + space # 0, width,
+    precision and length modifiers, which are ignored since argument type is known.
+    Width and precision given by '*' and %e %g are not supported, %f precision is up to 9
+*/
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "log_.h"
+
+#if __cplusplus < 201703L
+#    error log_.hpp requires C++17
+#endif  // __cplusplus
+
+#if LOG_ENABLED == 1U
+
+namespace log_ {
+namespace detail {
+
+/* ===== FORMAT PARSER ====================================================== */
+
+enum class arg_kind_t {
+    integer,
+    floating,
+    string,
+    pointer,
+    unsupported,
+};
+
+enum class format_error_t {
+    none,
+    too_few_arguments,
+    too_many_arguments,
+    bad_specifier,
+    type_mismatch,
+    precision,
+};
+
+/* Specifier which starts at 'start', its conversion is zero when there are no more of them */
+struct spec_t {
+    std::size_t start = 0;
+    std::size_t end = 0;
+    char conversion = 0;
+    bool is_left = false;
+    bool is_zero = false;
+    bool is_plus = false;
+    bool is_space = false;
+    bool is_alternate = false;
+    std::uint32_t width = 0;
+    int precision = -1;
+};
+
+constexpr bool is_digit(char c) {
+    return (c >= '0') && (c <= '9');
+}
+
+/* Finds the next specifier at or after 'pos', conversion is '?' for broken one */
+constexpr spec_t parse_spec(std::string_view format, std::size_t pos) {
+    spec_t spec{};
+    std::size_t i = format.find('%', pos);
+    if (i == std::string_view::npos) {
+        spec.start = format.size();
+        spec.end = format.size();
+        return spec;
+    }
+    spec.start = i++;
+
+    for (; i < format.size(); i++) {
+        char c = format[i];
+        if (c == '-') {
+            spec.is_left = true;
+        } else if (c == '0') {
+            spec.is_zero = true;
+        } else if (c == '+') {
+            spec.is_plus = true;
+        } else if (c == ' ') {
+            spec.is_space = true;
+        } else if (c == '#') {
+            spec.is_alternate = true;
+        } else {
+            break;
+        }
+    }
+    for (; (i < format.size()) && is_digit(format[i]); i++) {
+        spec.width = (spec.width * 10U) + static_cast<std::uint32_t>(format[i] - '0');
+    }
+    if ((i < format.size()) && (format[i] == '.')) {
+        spec.precision = 0;
+        for (i++; (i < format.size()) && is_digit(format[i]); i++) {
+            spec.precision = (spec.precision * 10) + (format[i] - '0');
+        }
+    }
+    for (; i < format.size(); i++) {
+        char c = format[i];
+        if ((c != 'h') && (c != 'l') && (c != 'j') && (c != 'z') && (c != 't') && (c != 'L')) {
+            break;
+        }
+    }
+
+    spec.conversion = '?';
+    if (i < format.size()) {
+        char c = format[i++];
+        if ((c == 'd') || (c == 'i') || (c == 'u') || (c == 'x') || (c == 'X') || (c == 'o') || (c == 'c') ||
+            (c == 's') || (c == 'p') || (c == 'f') || (c == 'F') || (c == '%')) {
+            spec.conversion = c;
+        }
+    }
+    spec.end = i;
+    return spec;
+}
+
+constexpr bool is_accepted(char conversion, arg_kind_t kind) {
+    switch (conversion) {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        case 'c':
+            return kind == arg_kind_t::integer;
+        case 'f':
+        case 'F':
+            return kind == arg_kind_t::floating;
+        case 's':
+            return kind == arg_kind_t::string;
+        case 'p':
+            return (kind == arg_kind_t::pointer) || (kind == arg_kind_t::string);
+        default:
+            return false;
+    }
+}
+
+constexpr format_error_t check_format(std::string_view format, arg_kind_t const *kinds, std::size_t count) {
+    std::size_t arg = 0;
+    for (spec_t spec = parse_spec(format, 0); spec.conversion != 0; spec = parse_spec(format, spec.end)) {
+        if (spec.conversion == '?') {
+            return format_error_t::bad_specifier;
+        }
+        if (spec.conversion == '%') {
+            continue;
+        }
+        if (arg == count) {
+            return format_error_t::too_few_arguments;
+        }
+        if (is_accepted(spec.conversion, kinds[arg++]) == false) {
+            return format_error_t::type_mismatch;
+        }
+        if (((spec.conversion == 'f') || (spec.conversion == 'F')) && (spec.precision > 9)) {
+            return format_error_t::precision;
+        }
+    }
+    return (arg == count) ? format_error_t::none : format_error_t::too_many_arguments;
+}
+
+template <typename T>
+constexpr arg_kind_t arg_kind() {
+    using type_t = std::remove_cv_t<std::remove_reference_t<T>>;
+    if constexpr (std::is_integral_v<type_t> || std::is_enum_v<type_t>) {
+        return arg_kind_t::integer;
+    } else if constexpr (std::is_floating_point_v<type_t>) {
+        return arg_kind_t::floating;
+    } else if constexpr (std::is_same_v<std::decay_t<type_t>, char *> ||
+                         std::is_same_v<std::decay_t<type_t>, char const *> ||
+                         std::is_same_v<type_t, std::string_view>) {
+        return arg_kind_t::string;
+    } else if constexpr (std::is_pointer_v<std::decay_t<type_t>> || std::is_null_pointer_v<type_t>) {
+        return arg_kind_t::pointer;
+    } else {
+        return arg_kind_t::unsupported;
+    }
+}
+
+/* ===== ENCODERS =========================================================== */
+
+/* Message buffer, 'len' counts all bytes, only first LOG_MAX_MESSAGE_LENGTH are kept for truncation */
+struct writer_t {
+    char data[LOG_MAX_MESSAGE_LENGTH + 1U];
+    std::size_t len = 0;
+
+    void put(char const *text, std::size_t size) {
+        if (len < LOG_MAX_MESSAGE_LENGTH) {
+            std::size_t room = LOG_MAX_MESSAGE_LENGTH - len;
+            std::memcpy(&data[len], text, (size < room) ? size : room);
+        }
+        len += size;
+    }
+
+    void put(char c) {
+        if (len < LOG_MAX_MESSAGE_LENGTH) {
+            data[len] = c;
+        }
+        len++;
+    }
+
+    void fill(char c, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++) {
+            put(c);
+        }
+    }
+
+    /* Right aligns field which starts at 'start', zeros go after its sign */
+    void align(std::size_t start, spec_t const &spec, bool is_zero) {
+        std::size_t size = len - start;
+        if (size >= spec.width) {
+            return;
+        }
+        std::size_t pad = spec.width - size;
+        if (spec.is_left == true) {
+            fill(' ', pad);
+            return;
+        }
+        if ((len + pad) > LOG_MAX_MESSAGE_LENGTH) {
+            len += pad; /* Message is truncated anyway */
+            return;
+        }
+        if ((is_zero == true) && ((data[start] == '-') || (data[start] == '+') || (data[start] == ' '))) {
+            start++;
+            size--;
+        }
+        std::memmove(&data[start + pad], &data[start], size);
+        std::memset(&data[start], (is_zero == true) ? '0' : ' ', pad);
+        len += pad;
+    }
+};
+
+template <typename T, bool IsEnum = std::is_enum_v<T>>
+struct integer_type {
+    using type = T;
+};
+
+template <typename T>
+struct integer_type<T, true> {
+    using type = std::underlying_type_t<T>;
+};
+
+template <typename T>
+inline void put_integer(writer_t &writer, spec_t const &spec, T value) {
+    /* Argument is promoted as by varargs and reinterpreted by conversion as printf does */
+    using promoted_t = std::common_type_t<typename integer_type<T>::type, int>;
+    using unsigned_t = std::make_unsigned_t<promoted_t>;
+
+    if (spec.conversion == 'c') {
+        std::size_t start = writer.len;
+        writer.put(static_cast<char>(value));
+        writer.align(start, spec, false);
+        return;
+    }
+
+    char sign = 0;
+    unsigned_t magnitude = static_cast<unsigned_t>(static_cast<promoted_t>(value));
+    if ((spec.conversion == 'd') || (spec.conversion == 'i')) {
+        auto signed_value = static_cast<std::make_signed_t<promoted_t>>(magnitude);
+        if (signed_value < 0) {
+            sign = '-';
+            magnitude = static_cast<unsigned_t>(0U - magnitude);
+        } else if (spec.is_plus == true) {
+            sign = '+';
+        } else if (spec.is_space == true) {
+            sign = ' ';
+        }
+    }
+
+    char const *digits = (spec.conversion == 'X') ? "0123456789ABCDEF" : "0123456789abcdef";
+    unsigned_t base = 10U;
+    if ((spec.conversion == 'x') || (spec.conversion == 'X')) {
+        base = 16U;
+    } else if (spec.conversion == 'o') {
+        base = 8U;
+    }
+
+    char text[24];
+    std::size_t count = 0;
+    while (magnitude != 0) {
+        text[count++] = digits[magnitude % base];
+        magnitude /= base;
+    }
+    std::size_t precision = (spec.precision < 0) ? 1U : static_cast<std::size_t>(spec.precision);
+    bool is_prefixed = (spec.is_alternate == true) && (base != 10U) && (count > 0);
+
+    std::size_t start = writer.len;
+    if (sign != 0) {
+        writer.put(sign);
+    }
+    if (is_prefixed == true) {
+        writer.put((base == 8U) ? "0" : ((spec.conversion == 'X') ? "0X" : "0x"), (base == 8U) ? 1U : 2U);
+    }
+    if (count < precision) {
+        writer.fill('0', precision - count - (((is_prefixed == true) && (base == 8U)) ? 1U : 0U));
+    }
+    while (count > 0) {
+        writer.put(text[--count]);
+    }
+    writer.align(start, spec, (spec.is_zero == true) && (spec.precision < 0) && (is_prefixed == false));
+}
+
+inline void put_string(writer_t &writer, spec_t const &spec, std::string_view text) {
+    if ((spec.precision >= 0) && (text.size() > static_cast<std::size_t>(spec.precision))) {
+        text = text.substr(0, static_cast<std::size_t>(spec.precision));
+    }
+    std::size_t start = writer.len;
+    writer.put(text.data(), text.size());
+    writer.align(start, spec, false);
+}
+
+inline void put_string(writer_t &writer, spec_t const &spec, char const *text) {
+    if (text == nullptr) {
+        put_string(writer, spec, std::string_view("(null)"));
+        return;
+    }
+    std::size_t size = 0;
+    while ((text[size] != '\0') && ((spec.precision < 0) || (size < static_cast<std::size_t>(spec.precision)))) {
+        size++;
+    }
+    put_string(writer, spec, std::string_view(text, size));
+}
+
+inline void put_pointer(writer_t &writer, spec_t const &spec, void const *pointer) {
+    spec_t hex = spec;
+    hex.conversion = 'x';
+    hex.is_alternate = true;
+    hex.precision = -1;
+    hex.is_zero = false;
+    put_integer(writer, hex, reinterpret_cast<std::uintptr_t>(pointer));
+}
+
+inline void put_float(writer_t &writer, spec_t const &spec, double value) {
+    std::size_t start = writer.len;
+    if ((std::signbit(value) == false) && ((spec.is_plus == true) || (spec.is_space == true))) {
+        writer.put((spec.is_plus == true) ? '+' : ' ');
+    }
+    std::uint32_t decimals = (spec.precision < 0) ? 6U : static_cast<std::uint32_t>(spec.precision);
+    std::size_t room = (writer.len < LOG_MAX_MESSAGE_LENGTH) ? (LOG_MAX_MESSAGE_LENGTH - writer.len) : 0U;
+    int len = _log_ftoa(&writer.data[(room > 0) ? writer.len : 0], (room > 0) ? (room + 1U) : 0U, value, decimals);
+    writer.len += static_cast<std::size_t>(len);
+    writer.align(start, spec, (spec.is_zero == true) && (std::isfinite(value) == true));
+}
+
+template <typename T>
+inline void put_arg(writer_t &writer, spec_t const &spec, T const &value) {
+    constexpr arg_kind_t kind = arg_kind<T>();
+    if constexpr (kind == arg_kind_t::integer) {
+        put_integer(writer, spec, value);
+    } else if constexpr (kind == arg_kind_t::floating) {
+        put_float(writer, spec, static_cast<double>(value));
+    } else if constexpr (kind == arg_kind_t::string) {
+        if (spec.conversion == 'p') {
+            put_pointer(writer, spec, static_cast<void const *>(value));
+        } else {
+            put_string(writer, spec, value);
+        }
+    } else {
+        put_pointer(writer, spec, static_cast<void const *>(value));
+    }
+}
+
+/* ===== RENDERER =========================================================== */
+
+/* Text from 'Pos' to the next specifier is one constant copy, each specifier is encoder of its argument */
+template <typename Format, std::size_t Pos>
+inline void render(writer_t &writer) {
+    constexpr std::string_view format = Format::get();
+    constexpr spec_t spec = parse_spec(format, Pos);
+    if constexpr (spec.start > Pos) {
+        writer.put(&format[Pos], spec.start - Pos);
+    }
+    if constexpr (spec.conversion == '%') {
+        writer.put('%');
+        render<Format, spec.end>(writer);
+    }
+}
+
+template <typename Format, std::size_t Pos, typename T, typename... Args>
+inline void render(writer_t &writer, T const &arg, Args const &...args) {
+    constexpr std::string_view format = Format::get();
+    constexpr spec_t spec = parse_spec(format, Pos);
+    if constexpr (spec.start > Pos) {
+        writer.put(&format[Pos], spec.start - Pos);
+    }
+    if constexpr (spec.conversion == '%') {
+        writer.put('%');
+        render<Format, spec.end>(writer, arg, args...);
+    } else {
+        put_arg(writer, spec, arg);
+        render<Format, spec.end>(writer, args...);
+    }
+}
+
+template <typename Format, typename... Args>
+inline void write(log_mask_t level, bool add_formating, Format, Args const &...args) {
+    constexpr arg_kind_t kinds[] = { arg_kind<Args>()..., arg_kind_t::unsupported };
+    constexpr format_error_t error = check_format(Format::get(), kinds, sizeof...(Args));
+    static_assert(error != format_error_t::too_few_arguments, "LOG format has more specifiers than arguments");
+    static_assert(error != format_error_t::too_many_arguments, "LOG format has less specifiers than arguments");
+    static_assert(error != format_error_t::bad_specifier, "LOG format has unsupported specifier");
+    static_assert(error != format_error_t::type_mismatch, "LOG argument type doesn't match its specifier");
+    static_assert(error != format_error_t::precision, "LOG %f precision is limited by 9 digits");
+
+    writer_t writer;
+    render<Format, 0>(writer, args...);
+    _log_text(level, writer.data, writer.len, add_formating);
+}
+
+}  // namespace detail
+}  // namespace log_
+
+/* Format literal is carried by type, so it's known to compiler inside of templates */
+#    define _LOG_FORMAT(FORMAT)                              \
+        [] {                                                 \
+            struct _log_format {                             \
+                static constexpr std::string_view get() {    \
+                    return FORMAT;                           \
+                }                                            \
+            };                                               \
+            return _log_format{};                            \
+        }()
+
+#    undef LOG
+#    undef LOG_RAW
+#    define LOG(LEVEL, FORMAT, ...) \
+        _LOG_IF_ENABLED(LEVEL, ::log_::detail::write(LEVEL, true, _LOG_FORMAT(FORMAT), ##__VA_ARGS__))
+#    define LOG_RAW(FORMAT, ...) \
+        _LOG_IF_ENABLED(LOG_MASK_RAW, ::log_::detail::write(LOG_MASK_RAW, false, _LOG_FORMAT(FORMAT), ##__VA_ARGS__))
+
+#endif  // LOG_ENABLED == 1U
+
+#endif /*__LOG_HPP__*/
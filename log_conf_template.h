@@ -18,11 +18,36 @@
 */
 #define LOG_TIMESTAMP_FORMAT (0U)
 
+/*
+    Uptime is taken from io->get_ticks counter of LOG_TIMESTAMP_TICK_HZ, e.g. microseconds timer
+    or cycle counter, and printed as [sss.uuuuuu]. io->get_uptime_ms is still needed for LOG_EVERY_MS.
+    Counter must not wrap, so it needs LOG_TIMESTAMP_64BIT, 32 bits hardware counter is extended
+    by count of its overflows
+*/
+#define LOG_TIMESTAMP_TICKS   (0U)
+#define LOG_TIMESTAMP_TICK_HZ (1000000U)
+
+/*
+    Uptime is printed as time since the previous line, e.g. [+250] in units of the last digit,
+    full stamp is printed every LOG_TIMESTAMP_RESYNC_LINES lines or LOG_TIMESTAMP_RESYNC_S seconds
+*/
+#define LOG_TIMESTAMP_DELTA        (0U)
+#define LOG_TIMESTAMP_RESYNC_LINES (32U)
+#define LOG_TIMESTAMP_RESYNC_S     (1U)
+
 /*
     Thread safe mode, enable it if use RTOS
 */
 #define LOG_THREADSAFE_ENABLED (0U)
 
+/*
+    Each thread formats its line on own stack, lock is held only while line is written,
+    LOG call takes about LOG_MAX_MESSAGE_LENGTH + 200 bytes of stack more.
+    LOG_IO_ATOMIC skips the lock too, enable it if io->write and sinks write whole line at once
+*/
+#define LOG_PARALLEL_FORMAT (0U)
+#define LOG_IO_ATOMIC       (0U)
+
 /*
     Allow use timestamp as 64bit variable
 */
@@ -34,6 +59,17 @@
 */
 #define LOG_ISR_QUEUE (0U)
 
+/*
+    Size of lock-free ring for messages from interrupts, must be power of two,
+    messages which don't fit are dropped and counted
+*/
+#define LOG_ISR_QUEUE_SIZE (512U)
+
+/*
+    Max number of interrupt messages written by one flush, keeps main loop responsive
+*/
+#define LOG_ISR_FLUSH_BUDGET (8U)
+
 /*
    Internal buffer size
 */
@@ -44,7 +80,178 @@
 */
 #define LOG_MAX_MESSAGE_LENGTH (128U)
 
+/*
+    Built-in printf subset (d i u x X o c s p f F e E g G a A, flags, width, precision, length modifiers)
+    instead of vsnprintf, message is streamed to io by parts of line so it's never truncated,
+    LOG_MAX_MESSAGE_LENGTH only sets size of the part
+*/
+#define LOG_BUILTIN_PRINTF (0U)
+
+/*
+    Runtime masks per module set by log_set_module_mask(), module is LOG_MODULE_NAME
+    of the file, LOG_MODULES_MAX is number of modules which can be registered
+*/
+#define LOG_MODULES_ENABLED (0U)
+#define LOG_MODULES_MAX     (16U)
+
+/*
+    Additional sinks added by log_add_sink(), each one has its own mask, colors and
+    timestamp style, LOG_SINKS_MAX is number of sinks besides io->write
+*/
+#define LOG_SINKS_ENABLED (0U)
+#define LOG_SINKS_MAX     (4U)
+
+/*
+    Independent logger instances initialized by log_instance_init() and written by LOG_INSTANCE_* macros,
+    each one has its own io, lock, mask and line buffer of any size
+*/
+#define LOG_INSTANCES_ENABLED (0U)
+
+/*
+    Size of queue of every sink, must be power of two, zero disables queues,
+    queued sinks are written by log_process(), LOG_ASYNC_POLICY is applied when queue is full
+*/
+#define LOG_SINK_QUEUE_SIZE (0U)
+
+/*
+    Flight recorder, lines of levels set by log_recorder_set_mask() are copied to circular
+    buffer of LOG_RECORDER_SIZE bytes, even ones which are not written to io,
+    LOG_RECORDER_ATTRIBUTE places buffer to RAM which is not cleared on reset,
+    log_recorder_dump() writes it after restart
+*/
+#define LOG_RECORDER_ENABLED   (0U)
+#define LOG_RECORDER_SIZE      (4096U)
+#define LOG_RECORDER_ATTRIBUTE __attribute__((section(".noinit")))
+
+/*
+    Counters of log_get_stats(): messages, bytes, truncations and drops per level, time spent in io->write
+    and waiting for io->lock measured by LOG_STATS_CLOCK (uptime in ms if it isn't defined),
+    e.g. #define LOG_STATS_CLOCK() DWT->CYCCNT
+*/
+#define LOG_STATS_ENABLED (0U)
+
+/*
+    Timers of LOG_SCOPE_TIMER and LOG_TIME_BEGIN/END count calls, min, max, mean and log2 histogram
+    of LOG_TIMER_BUCKETS buckets without writing lines, log_dump_timers() writes them.
+    LOG_TIMERS_MAX is number of timer names, time is measured by LOG_TIMER_CLOCK,
+    io->get_ticks or io->get_uptime_ms, e.g. #define LOG_TIMER_CLOCK() DWT->CYCCNT
+*/
+#define LOG_TIMERS_ENABLED (0U)
+#define LOG_TIMERS_MAX     (16U)
+#define LOG_TIMER_BUCKETS  (16U)
+
+/*
+    Number of LOG_EVERY_MS call sites with own period and count of skipped messages,
+    sites which don't fit share the last one
+*/
+#define LOG_THROTTLES_MAX (16U)
+
+/*
+    Identical consecutive lines are written once and followed by
+    "Last message repeated N times" before the next different line
+*/
+#define LOG_COLLAPSE_REPEATS (0U)
+
+/*
+    Levels which are compiled in, LOG calls of other levels are removed,
+    e.g. (LOG_MASK_ERROR | LOG_MASK_WARNING) for release build
+*/
+#define LOG_COMPILE_MASK (0xFFU)
+
+/*
+    Digits after point printed by log_array_float(), up to 9
+*/
+#define LOG_FLOAT_DECIMALS (2U)
+
+/*
+    Bytes per row of log_hexdump()
+*/
+#define LOG_HEXDUMP_ROW_LENGTH (16U)
+
+/*
+    Sink accepts several buffers by one call, io->writev is used to write
+    ISR queue and batches of asynchronous mode messages
+*/
+#define LOG_IO_WRITEV (0U)
+
+/*
+    Sink buffers output, io->flush is called after lines of LOG_IO_FLUSH_MASK levels,
+    in asynchronous mode it's called by log_process() when they are written
+*/
+#define LOG_IO_FLUSH      (0U)
+#define LOG_IO_FLUSH_MASK (LOG_MASK_ERROR)
+
+/*
+    Line is formatted directly in sink memory given by io->reserve, io->commit passes it
+    to the sink instead of copying by io->write, e.g. into DMA buffer of UART.
+    It's skipped when io->reserve returns NULL, in interrupts and while sinks are added
+*/
+#define LOG_IO_RESERVE (0U)
+
+/*
+    Asynchronous mode, LOG calls put finished lines into lock-free ring buffer
+    and return, log_process() writes them to io->write from your thread
+*/
+#define LOG_ASYNC_ENABLED (0U)
+
+/*
+    Ring buffer size of asynchronous mode, must be power of two
+*/
+#define LOG_ASYNC_BUFFER_SIZE (1024U)
+
+/*
+    What to do when ring buffer is full:
+        LOG_ASYNC_DROP      - drop new message
+        LOG_ASYNC_OVERWRITE - drop oldest messages which are not written yet, whatever their level,
+                              with LOG_BACKPRESSURE_ENABLED lines of LOG_BACKPRESSURE_MASK aren't dropped
+                              for each other, new one is dropped instead
+*/
+#define LOG_ASYNC_POLICY LOG_ASYNC_DROP
+
+/*
+    Queues of asynchronous mode, interrupts and sinks keep last LOG_BACKPRESSURE_RESERVE percent
+    for lines of LOG_BACKPRESSURE_MASK levels, lines of other levels are shed when the rest is full.
+    Shed lines are reported per level when queue is drained below the reserve
+*/
+#define LOG_BACKPRESSURE_ENABLED (0U)
+#define LOG_BACKPRESSURE_MASK    (LOG_MASK_ERROR | LOG_MASK_WARNING)
+#define LOG_BACKPRESSURE_RESERVE (25U)
+
+/*
+    Non-blocking io: lines are collected in LOG_IO_BUFFERS buffers of LOG_IO_BUFFER_SIZE bytes,
+    io->write_async sends one of them while the next one is filled, driver calls
+    log_write_complete() when it's sent. What to do when all buffers are busy:
+        LOG_ASYNC_DROP      - drop new message
+        LOG_ASYNC_OVERWRITE - drop messages which wait in the buffer being filled
+        LOG_ASYNC_BLOCK     - io->wait until log_write_complete(), it must not be blocked by LOG caller
+    Bytes in buffers don't keep levels, to drop the lowest level first use LOG_ASYNC_BLOCK with
+    LOG_ASYNC_ENABLED and LOG_BACKPRESSURE_ENABLED, queue sheds lines while log_process() waits
+*/
+#define LOG_IO_WRITE_ASYNC   (0U)
+#define LOG_IO_BUFFERS       (2U)
+#define LOG_IO_BUFFER_SIZE   (512U)
+#define LOG_IO_BUFFER_POLICY LOG_ASYNC_DROP
+
 /*
    Use colors
 */
 #define LOG_ENABLED_COLOR (1U)
+
+/*
+    Output of io->write is compressed by LZSS, window of LOG_COMPRESS_WINDOW bytes (256 to 4096)
+    is kept between lines, RAM is about 3.5 * LOG_COMPRESS_WINDOW plus one line.
+    Every write is one block, so latency isn't increased. Each LOG_COMPRESS_SYNC_INTERVAL
+    bytes window is reset, decoder can join the stream there. Window starts with
+    LOG_COMPRESS_DICTIONARY, put frequent tags and format strings to it.
+    tools/log_uncompress.c restores the stream on host
+*/
+#define LOG_COMPRESS_ENABLED       (0U)
+#define LOG_COMPRESS_WINDOW        (1024U)
+#define LOG_COMPRESS_SYNC_INTERVAL (4096U)
+
+/*
+    Deferred formatting, LOG macros send binary frames with format id, timestamp
+    and raw arguments instead of text, tools/log_decode.c turns stream back to text.
+    Requires GCC or Clang and linker which provides __start_/__stop_ section symbols
+*/
+#define LOG_DEFERRED_FORMAT (0U)
@@ -0,0 +1,370 @@
+#if !defined(_POSIX_C_SOURCE)
+#    define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "log_file.h"
+
+#if LOG_ENABLED == 1
+
+#    include <errno.h>
+#    include <fcntl.h>
+#    include <limits.h>
+#    include <pthread.h>
+#    include <stdio.h>
+#    include <string.h>
+#    include <sys/stat.h>
+#    include <time.h>
+#    include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_FILE_BUFFER_SIZE < 256U
+#        error LOG_FILE_BUFFER_SIZE must be at least 256 bytes
+#    endif
+
+/*
+    Callers fill active buffer, background thread writes the other one,
+    buffers are swapped when active one is full, flushed or by timeout
+*/
+typedef struct {
+    log_file_config_t config;
+    int fd;
+    size_t file_size;
+    uint8_t buffers[2][LOG_FILE_BUFFER_SIZE];
+    uint32_t active;
+    size_t len;
+    size_t pending_len;
+    /* Bytes of batches dropped while the file couldn't be opened */
+    size_t dropped;
+    bool is_pending;
+    /* Caller may wait for the thread in the middle of its line, other callers wait until it ends */
+    bool is_exclusive;
+    bool is_flush;
+    bool is_running;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    /* Wakes background thread */
+    pthread_cond_t wake;
+    /* Background thread has written pending buffer */
+    pthread_cond_t done;
+} log_file_t;
+
+/* -------------------------------------------------------------------------- */
+
+static void *_file_thread(void *arg);
+static void _file_swap(void);
+static void _file_begin(void);
+static void _file_end(void);
+static void _file_put(const uint8_t *data, size_t size);
+static void _file_write(uint8_t const *data, size_t size);
+static void _file_rotate(void);
+static bool _file_reopen(void);
+static int _file_open(char const *path, bool is_truncate);
+
+/* -------------------------------------------------------------------------- */
+
+static log_file_t _file = {
+    .fd = -1,
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* -------------------------------------------------------------------------- */
+
+log_result_t log_file_open(log_file_config_t const *config) {
+    if ((config == NULL) || (config->path == NULL) || (_file.is_running == true)) {
+        return LOGGER_RESULT_ERROR;
+    }
+
+    int fd = _file_open(config->path, false);
+    if (fd < 0) {
+        return LOGGER_RESULT_ERROR;
+    }
+    struct stat info;
+    _file.file_size = (fstat(fd, &info) == 0) ? (size_t)info.st_size : 0;
+    _file.fd = fd;
+    _file.config = *config;
+    _file.active = 0;
+    _file.len = 0;
+    _file.dropped = 0;
+    _file.is_pending = false;
+    _file.is_exclusive = false;
+    _file.is_flush = false;
+    _file.is_running = true;
+
+    /* Timeout of flush_ms is measured by monotonic clock, wall clock can jump */
+    pthread_condattr_t attr;
+    (void)pthread_condattr_init(&attr);
+    (void)pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    (void)pthread_cond_init(&_file.wake, &attr);
+    (void)pthread_condattr_destroy(&attr);
+    (void)pthread_cond_init(&_file.done, NULL);
+
+    if (pthread_create(&_file.thread, NULL, _file_thread, NULL) != 0) {
+        _file.is_running = false;
+        (void)pthread_cond_destroy(&_file.wake);
+        (void)pthread_cond_destroy(&_file.done);
+        (void)close(fd);
+        _file.fd = -1;
+        return LOGGER_RESULT_ERROR;
+    }
+
+    return LOGGER_RESULT_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void log_file_close(void) {
+    (void)pthread_mutex_lock(&_file.mutex);
+    bool is_running = _file.is_running;
+    _file.is_running = false;
+    (void)pthread_cond_signal(&_file.wake);
+    (void)pthread_mutex_unlock(&_file.mutex);
+    if (is_running == false) {
+        return;
+    }
+
+    /* Thread writes the rest before exit */
+    (void)pthread_join(_file.thread, NULL);
+    (void)pthread_cond_destroy(&_file.wake);
+    (void)pthread_cond_destroy(&_file.done);
+    if (_file.fd >= 0) {
+        (void)fsync(_file.fd);
+        (void)close(_file.fd);
+        _file.fd = -1;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+void log_file_write(const uint8_t *data, size_t size) {
+    (void)pthread_mutex_lock(&_file.mutex);
+    _file_begin();
+    _file_put(data, size);
+    _file_end();
+    (void)pthread_mutex_unlock(&_file.mutex);
+}
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_IO_WRITEV == 1U
+
+void log_file_writev(const log_iovec_t *iov, size_t count) {
+    (void)pthread_mutex_lock(&_file.mutex);
+    _file_begin();
+    for (size_t i = 0; i < count; i++) {
+        _file_put(iov[i].data, iov[i].size);
+    }
+    _file_end();
+    (void)pthread_mutex_unlock(&_file.mutex);
+}
+
+#    endif  // LOG_IO_WRITEV == 1U
+
+/* -------------------------------------------------------------------------- */
+
+void log_file_flush(void) {
+    (void)pthread_mutex_lock(&_file.mutex);
+    _file.is_flush = true;
+    (void)pthread_cond_signal(&_file.wake);
+    (void)pthread_mutex_unlock(&_file.mutex);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/*
+    Called under the mutex. Swap may wait for the thread and release the mutex in the middle of the line,
+    when the line is longer than the buffer or comes in several pieces of writev, so callers take turns
+*/
+static void _file_begin(void) {
+    while (_file.is_exclusive == true) {
+        (void)pthread_cond_wait(&_file.done, &_file.mutex);
+    }
+    _file.is_exclusive = true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _file_end(void) {
+    _file.is_exclusive = false;
+    (void)pthread_cond_broadcast(&_file.done);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Called between _file_begin() and _file_end(), lines written before log_file_open() or after log_file_close() are dropped */
+static void _file_put(const uint8_t *data, size_t size) {
+    if (_file.is_running == false) {
+        return;
+    }
+
+    /* Line which fits isn't split by the swap */
+    if ((_file.len + size) > LOG_FILE_BUFFER_SIZE) {
+        _file_swap();
+    }
+    while (size > 0) {
+        if (_file.len == LOG_FILE_BUFFER_SIZE) {
+            _file_swap();
+        }
+        size_t count = LOG_FILE_BUFFER_SIZE - _file.len;
+        if (count > size) {
+            count = size;
+        }
+        memcpy(&_file.buffers[_file.active][_file.len], data, count);
+        _file.len += count;
+        data += count;
+        size -= count;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Hands active buffer to background thread, waits only if it still writes the previous one */
+static void _file_swap(void) {
+    while (_file.is_pending == true) {
+        (void)pthread_cond_wait(&_file.done, &_file.mutex);
+    }
+    _file.pending_len = _file.len;
+    _file.is_pending = true;
+    _file.active ^= 1U;
+    _file.len = 0;
+    (void)pthread_cond_signal(&_file.wake);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void *_file_thread(void *arg) {
+    (void)arg;
+
+    (void)pthread_mutex_lock(&_file.mutex);
+    for (;;) {
+        if (_file.is_pending == false) {
+            bool is_stopping = (_file.is_running == false);
+            if ((_file.len > 0) && ((_file.is_flush == true) || (is_stopping == true))) {
+                _file.is_flush = false;
+                _file_swap();
+                continue;
+            }
+            if (is_stopping == true) {
+                break;
+            }
+
+            if (_file.config.flush_ms == 0) {
+                (void)pthread_cond_wait(&_file.wake, &_file.mutex);
+                continue;
+            }
+            struct timespec deadline;
+            (void)clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_sec += (time_t)(_file.config.flush_ms / 1000U);
+            deadline.tv_nsec += (long)(_file.config.flush_ms % 1000U) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            if (pthread_cond_timedwait(&_file.wake, &_file.mutex, &deadline) == ETIMEDOUT) {
+                _file.is_flush = true;
+            }
+            continue;
+        }
+
+        /* Buffer isn't touched by callers while it's pending, it's written without the mutex */
+        uint8_t const *data = _file.buffers[_file.active ^ 1U];
+        size_t size = _file.pending_len;
+        (void)pthread_mutex_unlock(&_file.mutex);
+
+        _file_write(data, size);
+
+        (void)pthread_mutex_lock(&_file.mutex);
+        _file.is_pending = false;
+        (void)pthread_cond_broadcast(&_file.done);
+    }
+    (void)pthread_mutex_unlock(&_file.mutex);
+
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Runs in background thread, batch which can't be written is dropped */
+static void _file_write(uint8_t const *data, size_t size) {
+    if ((_file.fd < 0) && (_file_reopen() == false)) {
+        _file.dropped += size;
+        return;
+    }
+    while (size > 0) {
+        ssize_t len = write(_file.fd, data, size);
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        data += len;
+        size -= (size_t)len;
+        _file.file_size += (size_t)len;
+    }
+
+    if (_file.config.is_fsync == true) {
+        (void)fsync(_file.fd);
+    }
+    if ((_file.config.rotate_size > 0) && (_file.file_size >= _file.config.rotate_size)) {
+        _file_rotate();
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* path.N-1 becomes path.N and so on, current file becomes path.1, the oldest one is overwritten */
+static void _file_rotate(void) {
+    char from[PATH_MAX];
+    char to[PATH_MAX];
+
+    (void)close(_file.fd);
+    for (uint32_t i = _file.config.archives; i > 1U; i--) {
+        (void)snprintf(from, sizeof(from), "%s.%" PRIu32, _file.config.path, i - 1U);
+        (void)snprintf(to, sizeof(to), "%s.%" PRIu32, _file.config.path, i);
+        (void)rename(from, to);
+    }
+    if (_file.config.archives > 0) {
+        (void)snprintf(to, sizeof(to), "%s.1", _file.config.path);
+        (void)rename(_file.config.path, to);
+    }
+
+    /* Without archives the file starts over, if it can't be opened the next batch tries again */
+    _file.fd = _file_open(_file.config.path, true);
+    _file.file_size = 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Opens the file after failed rotation, the first line tells how much was lost meanwhile */
+static bool _file_reopen(void) {
+    _file.fd = _file_open(_file.config.path, false);
+    if (_file.fd < 0) {
+        return false;
+    }
+    struct stat info;
+    _file.file_size = (fstat(_file.fd, &info) == 0) ? (size_t)info.st_size : 0;
+    if (_file.dropped > 0) {
+        char text[64];
+        int len = snprintf(text, sizeof(text), "%zu bytes were dropped, file couldn't be opened" LOG_ENDLINE, _file.dropped);
+        _file.dropped = 0;
+        if ((len > 0) && (write(_file.fd, text, (size_t)len) == (ssize_t)len)) {
+            _file.file_size += (size_t)len;
+        }
+    }
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static int _file_open(char const *path, bool is_truncate) {
+    int flags = O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC;
+    if (is_truncate == true) {
+        flags |= O_TRUNC;
+    }
+    return open(path, flags, 0644);
+}
+
+/* -------------------------------------------------------------------------- */
+
+#endif  // LOG_ENABLED == 1
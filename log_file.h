@@ -0,0 +1,58 @@
+#ifndef __LOG_FILE_H__
+#define __LOG_FILE_H__
+
+/*
+    POSIX file backend of log_io_t. Lines are collected in RAM buffer and written
+    by background thread, it also rotates files and calls fsync, so LOG caller
+    only copies the line. Caller waits only when both buffers are full.
+
+    log_file_config_t config = { .path = "/var/log/app.log", .rotate_size = 8U << 20, .archives = 4U,
+                                 .flush_ms = 1000U, .is_fsync = true };
+    log_file_open(&config);
+    log_io_t io = { .write = log_file_write, .flush = log_file_flush, ... };
+*/
+
+#include "log_.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if LOG_ENABLED == 1U
+
+#    if !defined(LOG_FILE_BUFFER_SIZE)
+#        define LOG_FILE_BUFFER_SIZE (65536U)
+#    endif  // LOG_FILE_BUFFER_SIZE
+
+typedef struct {
+    const char *path;
+    /* File is moved to archive when it grows over this size, 0 disables rotation */
+    size_t rotate_size;
+    /* Number of archives path.1 (newest) .. path.N, the oldest one is removed */
+    uint32_t archives;
+    /* Collected lines are written at least this often, 0 - only when buffer is full or flushed */
+    uint32_t flush_ms;
+    /* Background thread calls fsync after each write */
+    bool is_fsync;
+} log_file_config_t;
+
+/* Opens file for appending and starts background thread, only one file is open at a time */
+log_result_t log_file_open(log_file_config_t const *config);
+/* Writes everything collected, stops the thread and closes the file */
+void log_file_close(void);
+
+/* io->write, it's safe to call it from several threads, so LOG_IO_ATOMIC can be used */
+void log_file_write(const uint8_t *data, size_t size);
+#    if LOG_IO_WRITEV == 1U
+void log_file_writev(const log_iovec_t *iov, size_t count);
+#    endif  // LOG_IO_WRITEV == 1U
+/* io->flush, wakes background thread to write collected lines now, doesn't wait for it */
+void log_file_flush(void);
+
+#endif  // LOG_ENABLED == 1U
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__LOG_FILE_H__*/
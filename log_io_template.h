@@ -40,6 +40,15 @@ static inline log_timestamp_t _get_up_time_ms(void) {
 
 /* -------------------------------------------------------------------------- */
 
+#        if LOG_TIMESTAMP_TICKS == 1U
+static inline log_timestamp_t _get_ticks(void) {
+    // There is template, just add your implementation, e.g. return DWT->CYCCNT
+    return (log_timestamp_t)0;
+}
+#        endif  // LOG_TIMESTAMP_TICKS == 1U
+
+/* -------------------------------------------------------------------------- */
+
 #        if LOG_TIMESTAMP_FORMAT > 0
 static inline time_t _get_utc_timestamp(void) {
     // There is template, just add your implementation
@@ -61,6 +70,57 @@ static bool _is_isr(void) {
 
 /* -------------------------------------------------------------------------- */
 
+#    if LOG_IO_WRITEV == 1U
+
+static void _log_writev(const log_iovec_t *iov, size_t count) {
+    // There is template, just add your implementation
+}
+
+#    endif  // LOG_IO_WRITEV == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_IO_FLUSH == 1U
+
+static void _log_flush(void) {
+    // There is template, just add your implementation
+}
+
+#    endif  // LOG_IO_FLUSH == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_IO_RESERVE == 1U
+
+static uint8_t *_log_reserve(size_t size) {
+    // There is template, just add your implementation
+    return NULL;
+}
+
+static void _log_commit(size_t size) {
+    // There is template, just add your implementation
+}
+
+#    endif  // LOG_IO_RESERVE == 1U
+
+/* -------------------------------------------------------------------------- */
+
+#    if LOG_IO_WRITE_ASYNC == 1U
+
+static void _log_write_async(const uint8_t *data, size_t size) {
+    // There is template, just add your implementation, call log_write_complete() from TX complete interrupt
+}
+
+#        if LOG_IO_BUFFER_POLICY == LOG_ASYNC_BLOCK
+static void _log_wait(void) {
+    // There is template, just add your implementation, e.g. take semaphore given after log_write_complete() or __WFI()
+}
+#        endif  // LOG_IO_BUFFER_POLICY == LOG_ASYNC_BLOCK
+
+#    endif  // LOG_IO_WRITE_ASYNC == 1U
+
+/* -------------------------------------------------------------------------- */
+
 const log_io_t log_io_interface = {
     .write = _log_write,
 #    if LOG_THREADSAFE_ENABLED == 1U
@@ -69,6 +129,9 @@ const log_io_t log_io_interface = {
 #    endif  // LOG_THREADSAFE_ENABLED == 1U
 #    if LOG_TIMESTAMP_ENABLED == 1U
     .get_uptime_ms = _get_up_time_ms,
+#        if LOG_TIMESTAMP_TICKS == 1U
+    .get_ticks = _get_ticks,
+#        endif  // LOG_TIMESTAMP_TICKS == 1U
 #        if LOG_TIMESTAMP_FORMAT > 0
     .get_utc_time_s = _get_utc_timestamp,
 #        endif  // LOG_TIMESTAMP_FORMAT > 0
@@ -76,6 +139,22 @@ const log_io_t log_io_interface = {
 #    if LOG_ISR_QUEUE == 1U
     .is_isr = _is_isr,
 #    endif  // LOG_ISR_QUEUE == 1U
+#    if LOG_IO_WRITEV == 1U
+    .writev = _log_writev,
+#    endif  // LOG_IO_WRITEV == 1U
+#    if LOG_IO_FLUSH == 1U
+    .flush = _log_flush,
+#    endif  // LOG_IO_FLUSH == 1U
+#    if LOG_IO_RESERVE == 1U
+    .reserve = _log_reserve,
+    .commit = _log_commit,
+#    endif  // LOG_IO_RESERVE == 1U
+#    if LOG_IO_WRITE_ASYNC == 1U
+    .write_async = _log_write_async,
+#        if LOG_IO_BUFFER_POLICY == LOG_ASYNC_BLOCK
+    .wait = _log_wait,
+#        endif  // LOG_IO_BUFFER_POLICY == LOG_ASYNC_BLOCK
+#    endif  // LOG_IO_WRITE_ASYNC == 1U
 };
 
 /* -------------------------------------------------------------------------- */
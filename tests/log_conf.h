@@ -0,0 +1,20 @@
+#ifndef __LOG_CONF_H__
+#define __LOG_CONF_H__
+
+/*
+    Configuration of tests, options under test are passed by compiler
+    definitions of each log_test_<name> target, lines have no timestamp, so output can be compared,
+    others keep defaults of log_.h
+*/
+
+#define LOG_ENABLED (1U)
+
+#if !defined(LOG_ENDLINE)
+#    define LOG_ENDLINE "\n"
+#endif  // LOG_ENDLINE
+
+#if !defined(LOG_TIMESTAMP_ENABLED)
+#    define LOG_TIMESTAMP_ENABLED (0U)
+#endif  // LOG_TIMESTAMP_ENABLED
+
+#endif /*__LOG_CONF_H__*/
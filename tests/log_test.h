@@ -0,0 +1,25 @@
+#ifndef __LOG_TEST_H__
+#define __LOG_TEST_H__
+
+/*
+    Checks of tests, failed check is printed and counted, test returns LOG_TEST_RESULT() from main
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static unsigned _log_test_failures;
+
+#define LOG_TEST_CHECK(CONDITION, ...)                                         \
+    do {                                                                       \
+        if (!(CONDITION)) {                                                    \
+            _log_test_failures++;                                              \
+            fprintf(stderr, "%s:%d: check failed: ", __FILE__, __LINE__);      \
+            fprintf(stderr, __VA_ARGS__);                                      \
+            fprintf(stderr, "\n");                                             \
+        }                                                                      \
+    } while (0)
+
+#define LOG_TEST_RESULT() ((_log_test_failures == 0U) ? EXIT_SUCCESS : EXIT_FAILURE)
+
+#endif /*__LOG_TEST_H__*/
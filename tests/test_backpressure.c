@@ -0,0 +1,178 @@
+/*
+    Test of LOG_BACKPRESSURE_ENABLED with throttled sink.
+
+    Asynchronous ring is drained by two lines per round while each round logs three lines of debug and info
+    in turns and every tenth round an error line. Ring fills up, debug and info lines are shed at the limit, errors take
+    the reserved room, so every error is delivered in order and nothing is dropped. Delivered lines and
+    ones reported by "Shed by backpressure:" add up to logged lines of each level. Statistics count bytes of
+    delivered lines only.
+
+    Built with LOG_ASYNC_OVERWRITE it fills the ring by errors without draining, new errors are dropped
+    instead of evicting older ones, so the first errors are delivered.
+*/
+
+#include <string.h>
+
+#include "log_.c"
+#include "log_test.h"
+
+#if (LOG_ASYNC_ENABLED != 1U) || (LOG_BACKPRESSURE_ENABLED != 1U) || (LOG_STATS_ENABLED != 1U)
+#    error Backpressure test must be built with LOG_ASYNC_ENABLED, LOG_BACKPRESSURE_ENABLED and LOG_STATS_ENABLED
+#endif
+
+#define _ROUNDS      (5000U)
+#define _ERROR_EVERY (10U)
+#define _LOW_LINES   (3U)
+/* Lines written by the sink per round, less than logged ones */
+#define _SINK_BUDGET (2U)
+/* Errors logged without draining, more than the ring takes */
+#define _OVERFLOW_LINES (500U)
+
+static char _out[512U * 1024U];
+static size_t _out_len;
+
+/* -------------------------------------------------------------------------- */
+
+static void _write(const uint8_t *data, size_t size) {
+    if ((_out_len + size) < sizeof(_out)) {
+        memcpy(&_out[_out_len], data, size);
+        _out_len += size;
+        _out[_out_len] = '\0';
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static const log_io_t _io = {
+    .write = _write,
+};
+
+/* -------------------------------------------------------------------------- */
+
+/* Adds counters of "Shed by backpressure: <level> <count> ..." */
+static void _parse_shed(char const *report, uint32_t *shed_debug, uint32_t *shed_info) {
+    char name[16];
+    unsigned count = 0;
+    int len = 0;
+    while (sscanf(report, " %15s %u%n", name, &count, &len) == 2) {
+        if (strcmp(name, "debug") == 0) {
+            *shed_debug += count;
+        } else if (strcmp(name, "info") == 0) {
+            *shed_info += count;
+        } else {
+            LOG_TEST_CHECK(false, "%s lines are shed", name);
+        }
+        report += len;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+#if LOG_ASYNC_POLICY == LOG_ASYNC_OVERWRITE
+
+static void _test_overwrite(void) {
+    _out_len = 0;
+    _out[0] = '\0';
+    for (uint32_t i = 0; i < _OVERFLOW_LINES; i++) {
+        log_it(LOG_MASK_ERROR, "overflow %" PRIu32, i);
+    }
+    (void)log_process();
+
+    uint32_t next = 0;
+    bool is_reported = false;
+    char *line = _out;
+    char *end = NULL;
+    while ((end = strchr(line, '\n')) != NULL) {
+        *end = '\0';
+        unsigned value = 0;
+        if (sscanf(line, "overflow %u", &value) == 1) {
+            LOG_TEST_CHECK(value == next, "overflow %u, expected %" PRIu32, value, next);
+            next = value + 1U;
+        } else if (strstr(line, "messages were dropped") != NULL) {
+            is_reported = true;
+        } else {
+            LOG_TEST_CHECK(false, "unexpected line '%s'", line);
+        }
+        line = end + 1;
+    }
+    printf("overwrite delivered %" PRIu32 " of %" PRIu32 " errors\n", next, _OVERFLOW_LINES);
+    LOG_TEST_CHECK((next > 0) && (next < _OVERFLOW_LINES), "%" PRIu32 " errors are delivered", next);
+    LOG_TEST_CHECK(is_reported == true, "dropped errors aren't reported");
+}
+
+#endif  // LOG_ASYNC_POLICY == LOG_ASYNC_OVERWRITE
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    LOG_TEST_CHECK(log_init(LOG_MASK_ALL, &_io) == LOGGER_RESULT_OK, "log_init failed");
+
+    uint32_t errors = 0;
+    uint32_t low = 0;
+    for (uint32_t i = 0; i < _ROUNDS; i++) {
+        /* Odd number of lines per round, so the line which finds the ring full isn't always of one level */
+        for (uint32_t j = 0; j < _LOW_LINES; j++) {
+            if ((low % 2U) == 0) {
+                log_it(LOG_MASK_DEBUG, "debug %" PRIu32, low);
+            } else {
+                log_it(LOG_MASK_INFO, "info %" PRIu32, low);
+            }
+            low++;
+        }
+        if ((i % _ERROR_EVERY) == 0) {
+            log_it(LOG_MASK_ERROR, "error %" PRIu32, errors);
+            errors++;
+        }
+        (void)_ring_drain(&_ctx.ring, _SINK_BUDGET);
+    }
+    (void)log_process();
+
+    uint32_t debug = 0;
+    uint32_t info = 0;
+    uint32_t next_error = 0;
+    uint32_t shed_debug = 0;
+    uint32_t shed_info = 0;
+    uint32_t reports = 0;
+    size_t debug_bytes = 0;
+    char *line = _out;
+    char *end = NULL;
+    while ((end = strchr(line, '\n')) != NULL) {
+        *end = '\0';
+        unsigned value = 0;
+        if (strncmp(line, "Shed by backpressure:", 21U) == 0) {
+            _parse_shed(&line[21], &shed_debug, &shed_info);
+            reports++;
+        } else if (sscanf(line, "error %u", &value) == 1) {
+            LOG_TEST_CHECK(value == next_error, "error %u, expected %" PRIu32, value, next_error);
+            next_error = value + 1U;
+        } else if (sscanf(line, "debug %u", &value) == 1) {
+            debug++;
+            debug_bytes += (size_t)(end + 1 - line);
+        } else if (sscanf(line, "info %u", &value) == 1) {
+            info++;
+        } else {
+            LOG_TEST_CHECK(false, "unexpected line '%s'", line);
+        }
+        line = end + 1;
+    }
+
+    printf("delivered debug %" PRIu32 " info %" PRIu32 " error %" PRIu32 ", shed debug %" PRIu32 " info %" PRIu32
+           " by %" PRIu32 " reports\n",
+           debug, info, next_error, shed_debug, shed_info, reports);
+    LOG_TEST_CHECK(next_error == errors, "%" PRIu32 " of %" PRIu32 " errors are delivered", next_error, errors);
+    LOG_TEST_CHECK((shed_debug > 0) && (shed_info > 0), "low levels aren't shed");
+    LOG_TEST_CHECK((debug + info + shed_debug + shed_info) == low, "%" PRIu32 " low lines are lost",
+                   low - debug - info - shed_debug - shed_info);
+    LOG_TEST_CHECK((debug + shed_debug) == ((low + 1U) / 2U), "%" PRIu32 " debug lines are lost",
+                   ((low + 1U) / 2U) - debug - shed_debug);
+    LOG_TEST_CHECK(atomic_load(&_ctx.ring.dropped) == 0, "lines are dropped");
+    uint32_t stats_bytes = atomic_load(&_ctx.stats.levels[_stats_level(LOG_MASK_DEBUG)].bytes);
+    LOG_TEST_CHECK(stats_bytes == debug_bytes, "%" PRIu32 " debug bytes are counted, %zu are delivered", stats_bytes,
+                   debug_bytes);
+
+#if LOG_ASYNC_POLICY == LOG_ASYNC_OVERWRITE
+    _test_overwrite();
+#endif  // LOG_ASYNC_POLICY == LOG_ASYNC_OVERWRITE
+
+    return LOG_TEST_RESULT();
+}
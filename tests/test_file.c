@@ -0,0 +1,203 @@
+/*
+    Test of log_file backend with buffers smaller than lines.
+
+    Several threads write numbered lines by write and writev in pieces, every third line is longer than
+    LOG_FILE_BUFFER_SIZE. Lines must be whole in the file and keep order of each thread.
+    Then rotation can't open the file, because its directory is removed. Batches are dropped until
+    the directory is back, the next batch opens the file and tells how many bytes were lost.
+*/
+
+#include "log_file.c"
+
+#include <sched.h>
+#include <sys/stat.h>
+
+#include "log_test.h"
+
+#if (LOG_FILE_BUFFER_SIZE >= 1024U) || (LOG_IO_WRITEV != 1U)
+#    error File test must be built with small LOG_FILE_BUFFER_SIZE and LOG_IO_WRITEV
+#endif
+
+#define _PATH    "log_test_file.log"
+#define _DIR     "log_test_file.dir"
+#define _THREADS (4U)
+#define _LINES   (20000U)
+#define _MAX_LEN (3U * LOG_FILE_BUFFER_SIZE)
+
+/* -------------------------------------------------------------------------- */
+
+static size_t _line_length(uint32_t thread, uint32_t number) {
+    return ((number % 3U) == 0) ? (LOG_FILE_BUFFER_SIZE + ((number * 7U + thread) % (2U * LOG_FILE_BUFFER_SIZE)))
+                                : (16U + ((number * 13U) % 64U));
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void *_writer(void *arg) {
+    uint32_t thread = (uint32_t)(uintptr_t)arg;
+    char head[32];
+    static const char endline[] = "\n";
+    char fill[_MAX_LEN];
+    memset(fill, 'a' + (int)thread, sizeof(fill));
+
+    for (uint32_t i = 0; i < _LINES; i++) {
+        int len = snprintf(head, sizeof(head), "t%" PRIu32 " n%" PRIu32 " ", thread, i);
+        size_t fill_len = _line_length(thread, i) - (size_t)len;
+        if ((i % 2U) == 0) {
+            char line[_MAX_LEN + 1U];
+            memcpy(line, head, (size_t)len);
+            memcpy(&line[len], fill, fill_len);
+            line[(size_t)len + fill_len] = '\n';
+            log_file_write((uint8_t const *)line, (size_t)len + fill_len + 1U);
+        } else {
+            log_iovec_t iov[3] = {
+                { .data = (uint8_t const *)head, .size = (size_t)len },
+                { .data = (uint8_t const *)fill, .size = fill_len },
+                { .data = (uint8_t const *)endline, .size = 1U },
+            };
+            log_file_writev(iov, 3U);
+        }
+    }
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static char *_read(char const *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        *size = 0;
+        return NULL;
+    }
+    (void)fseek(file, 0, SEEK_END);
+    *size = (size_t)ftell(file);
+    (void)fseek(file, 0, SEEK_SET);
+    char *text = malloc(*size + 1U);
+    *size = fread(text, 1U, *size, file);
+    text[*size] = '\0';
+    (void)fclose(file);
+    return text;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _test_long_lines(void) {
+    (void)unlink(_PATH);
+    log_file_config_t config = { .path = _PATH };
+    LOG_TEST_CHECK(log_file_open(&config) == LOGGER_RESULT_OK, "log_file_open failed");
+
+    pthread_t threads[_THREADS];
+    for (uint32_t i = 0; i < _THREADS; i++) {
+        (void)pthread_create(&threads[i], NULL, _writer, (void *)(uintptr_t)i);
+    }
+    for (uint32_t i = 0; i < _THREADS; i++) {
+        (void)pthread_join(threads[i], NULL);
+    }
+    log_file_close();
+
+    size_t size = 0;
+    char *text = _read(_PATH, &size);
+    LOG_TEST_CHECK(text != NULL, "no file");
+    if (text == NULL) {
+        return;
+    }
+
+    uint32_t next[_THREADS] = { 0 };
+    uint32_t lines = 0;
+    char *line = text;
+    char *end = NULL;
+    while ((end = strchr(line, '\n')) != NULL) {
+        /* sscanf takes length of the whole text otherwise */
+        *end = '\0';
+        unsigned thread = 0;
+        unsigned number = 0;
+        int len = 0;
+        bool is_parsed = (sscanf(line, "t%u n%u %n", &thread, &number, &len) == 2) && (len > 0) && (thread < _THREADS);
+        LOG_TEST_CHECK(is_parsed, "broken line '%.40s'", line);
+        if (is_parsed == false) {
+            break;
+        }
+        LOG_TEST_CHECK(number == next[thread], "thread %u line %u, expected %" PRIu32, thread, number, next[thread]);
+        next[thread] = number + 1U;
+        size_t line_len = (size_t)(end - line);
+        LOG_TEST_CHECK(line_len == _line_length(thread, number), "line %u of thread %u has %zu bytes", number, thread, line_len);
+        for (size_t i = (size_t)len; i < line_len; i++) {
+            if (line[i] != ('a' + (char)thread)) {
+                LOG_TEST_CHECK(false, "line %u of thread %u is mixed at %zu", number, thread, i);
+                break;
+            }
+        }
+        lines++;
+        line = end + 1;
+    }
+    printf("%" PRIu32 " lines, %zu bytes\n", lines, size);
+    LOG_TEST_CHECK(lines == (_THREADS * _LINES), "%" PRIu32 " lines in the file", lines);
+    LOG_TEST_CHECK(*line == '\0', "unfinished line");
+    free(text);
+    (void)unlink(_PATH);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Waits until background thread has written everything */
+static void _sync(void) {
+    log_file_flush();
+    for (;;) {
+        (void)pthread_mutex_lock(&_file.mutex);
+        bool is_written = (_file.is_flush == false) && (_file.is_pending == false) && (_file.len == 0);
+        (void)pthread_mutex_unlock(&_file.mutex);
+        if (is_written == true) {
+            return;
+        }
+        (void)sched_yield();
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _write_text(char const *text) {
+    log_file_write((uint8_t const *)text, strlen(text));
+    _sync();
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _test_reopen(void) {
+    (void)mkdir(_DIR, 0755);
+    log_file_config_t config = { .path = _DIR "/" _PATH, .rotate_size = 2U, .archives = 1U };
+    LOG_TEST_CHECK(log_file_open(&config) == LOGGER_RESULT_OK, "log_file_open failed");
+    (void)unlink(_DIR "/" _PATH);
+    (void)rmdir(_DIR);
+
+    /* Goes to removed file, its rotation fails */
+    _write_text("a\n");
+    LOG_TEST_CHECK(_file.fd < 0, "file is opened in removed directory");
+    _write_text("bb\n");
+    LOG_TEST_CHECK(_file.dropped == 3U, "%zu bytes are dropped", _file.dropped);
+
+    (void)mkdir(_DIR, 0755);
+    _write_text("c\n");
+    log_file_close();
+
+    size_t size = 0;
+    char *text = _read(_DIR "/" _PATH ".1", &size);
+    LOG_TEST_CHECK((text != NULL) && (strcmp(text, "3 bytes were dropped, file couldn't be opened\nc\n") == 0),
+                   "reopened file has '%s'",
+                   (text != NULL) ? text : "");
+    free(text);
+    text = _read(_DIR "/" _PATH, &size);
+    LOG_TEST_CHECK((text != NULL) && (size == 0), "rotated file isn't empty");
+    free(text);
+
+    (void)unlink(_DIR "/" _PATH ".1");
+    (void)unlink(_DIR "/" _PATH);
+    (void)rmdir(_DIR);
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    _test_long_lines();
+    _test_reopen();
+    return LOG_TEST_RESULT();
+}
@@ -0,0 +1,249 @@
+/*
+    Differential test of _log_ftoa() against snprintf("%.*f") of libc.
+
+    Output and return value must be the same for:
+        - float bit patterns taken by stride over the whole range and random doubles, decimals 0..9
+        - values near halfway of the last digit, binary fractions which are exact halves, their neighbours
+        - carry through all digits into integer part
+        - inf, nan, negative zero, denormals, values of 2^64 and above
+        - destination buffers shorter than the text
+    Then both are timed on the same values, result is one JSON line as log_bench prints.
+*/
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#include "log_.c"
+#include "log_test.h"
+
+#define _FLOAT_STRIDE   (4099U)
+#define _RANDOM_DOUBLES (500000U)
+#define _BENCH_VALUES   (4096U)
+#define _BENCH_ROUNDS   (100U)
+
+static uint64_t _checked;
+
+/* -------------------------------------------------------------------------- */
+
+static void _check(double value, uint32_t decimals) {
+    char expected[512];
+    char actual[512];
+    int expected_len = snprintf(expected, sizeof(expected), "%.*f", (int)decimals, value);
+    int actual_len = _log_ftoa(actual, sizeof(actual), value, decimals);
+    LOG_TEST_CHECK((expected_len == actual_len) && (strcmp(expected, actual) == 0),
+                   "%a %%.%" PRIu32 "f: expected '%s' (%d), got '%s' (%d)",
+                   value,
+                   decimals,
+                   expected,
+                   expected_len,
+                   actual,
+                   actual_len);
+    _checked++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _check_all_decimals(double value) {
+    for (uint32_t decimals = 0; decimals <= 9U; decimals++) {
+        _check(value, decimals);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _check_neighbours(double value) {
+    _check_all_decimals(value);
+    _check_all_decimals(nextafter(value, INFINITY));
+    _check_all_decimals(nextafter(value, -INFINITY));
+    _check_all_decimals(-value);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static uint64_t _random(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _test_floats(void) {
+    for (uint64_t bits = 0; bits <= 0xFFFFFFFFULL; bits += _FLOAT_STRIDE) {
+        uint32_t pattern = (uint32_t)bits;
+        float value = 0;
+        memcpy(&value, &pattern, sizeof(value));
+        _check_all_decimals(value);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _test_doubles(void) {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (uint32_t i = 0; i < _RANDOM_DOUBLES; i++) {
+        /* Exponents are limited to values which have digits among the first decimals */
+        uint64_t bits = _random(&state);
+        uint64_t exponent = 1023U - 40U + (bits % 120U);
+        bits = (bits & 0x800FFFFFFFFFFFFFULL) | (exponent << 52);
+        double value = 0;
+        memcpy(&value, &bits, sizeof(value));
+        _check(value, (uint32_t)(_random(&state) % 10U));
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _test_halfway(void) {
+    static const uint32_t pow10[] = { 1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U, 10000000U, 100000000U, 1000000000U };
+    for (uint32_t decimals = 0; decimals <= 9U; decimals++) {
+        for (uint32_t k = 0; k < 2000U; k++) {
+            /* Decimal halves are inexact in binary, their rounding depends on bits below the digit */
+            _check_neighbours(((double)k + 0.5) / (double)pow10[decimals]);
+            _check_neighbours((double)k * 1000003.0 + (0.5 / (double)pow10[decimals]));
+        }
+    }
+    /* Exact binary halves, rounded to even */
+    for (uint32_t bits = 1; bits <= 40U; bits++) {
+        for (uint64_t k = 1; k < 64U; k += 2U) {
+            _check_neighbours(ldexp((double)k, -(int)bits));
+            _check_neighbours(ldexp((double)k, -(int)bits) + 12345.0);
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _test_carry(void) {
+    static const double values[] = {
+        0.5,        1.5,        2.5,           0.05,          0.15,         0.25,
+        0.95,       9.5,        99.5,          0.995,         9.9999999995, 0.9999999996,
+        999999.5,   4294967295.5, 4294967296.5, 9007199254740991.0, 9007199254740993.0,
+        18446744073709549568.0, 0.49999999999999994,
+    };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        _check_neighbours(values[i]);
+    }
+    for (uint32_t digits = 1; digits <= 18U; digits++) {
+        /* 9...9.99...9 carries through every digit */
+        double nines = 1.0;
+        for (uint32_t i = 0; i < digits; i++) {
+            nines *= 10.0;
+        }
+        _check_neighbours(nines - 0.0000000001);
+        _check_neighbours(nines - 0.5);
+        _check_neighbours(nines - 1.0);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _test_special(void) {
+    static const double values[] = {
+        0.0,
+        1.0,
+        INFINITY,
+        DBL_MIN,
+        DBL_MAX,
+        DBL_EPSILON,
+        FLT_MIN,
+        FLT_MAX,
+        4.9406564584124654e-324,
+        2.2250738585072009e-308,
+        1e-10,
+        1e19,
+        18446744073709551616.0,
+        18446744073709555712.0,
+        1e300,
+    };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        _check_all_decimals(values[i]);
+        _check_all_decimals(-values[i]);
+    }
+    _check_all_decimals(NAN);
+    _check_all_decimals(-NAN);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _test_truncation(void) {
+    static const double values[] = { 0.0, -1.25, 123456.789, -INFINITY, NAN, 1e25 };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        for (size_t size = 0; size < 40U; size++) {
+            char expected[40];
+            char actual[40];
+            memset(expected, '#', sizeof(expected));
+            memset(actual, '#', sizeof(actual));
+            int expected_len = snprintf(expected, size, "%.*f", 3, values[i]);
+            int actual_len = _log_ftoa(actual, size, values[i], 3U);
+            LOG_TEST_CHECK((expected_len == actual_len) && (memcmp(expected, actual, sizeof(actual)) == 0),
+                           "%g in %zu bytes: expected '%.*s', got '%.*s'",
+                           values[i],
+                           size,
+                           (int)size,
+                           expected,
+                           (int)size,
+                           actual);
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static uint64_t _now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _bench(void) {
+    static float values[_BENCH_VALUES];
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    for (size_t i = 0; i < _BENCH_VALUES; i++) {
+        values[i] = (float)((double)(int64_t)(_random(&state) % 2000000U) / 1000.0 - 1000.0);
+    }
+
+    char buff[64];
+    volatile size_t sink = 0;
+    uint64_t start = _now_ns();
+    for (uint32_t round = 0; round < _BENCH_ROUNDS; round++) {
+        for (size_t i = 0; i < _BENCH_VALUES; i++) {
+            sink += (size_t)_log_ftoa(buff, sizeof(buff), values[i], LOG_FLOAT_DECIMALS);
+        }
+    }
+    uint64_t ftoa_ns = _now_ns() - start;
+
+    start = _now_ns();
+    for (uint32_t round = 0; round < _BENCH_ROUNDS; round++) {
+        for (size_t i = 0; i < _BENCH_VALUES; i++) {
+            sink += (size_t)snprintf(buff, sizeof(buff), "%.*f", (int)LOG_FLOAT_DECIMALS, values[i]);
+        }
+    }
+    uint64_t snprintf_ns = _now_ns() - start;
+    (void)sink;
+
+    double calls = (double)_BENCH_VALUES * _BENCH_ROUNDS;
+    printf("{\"case\":\"ftoa\",\"decimals\":%u,\"log_ftoa_ns\":%.1f,\"snprintf_ns\":%.1f}\n",
+           (unsigned)LOG_FLOAT_DECIMALS,
+           (double)ftoa_ns / calls,
+           (double)snprintf_ns / calls);
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    _test_floats();
+    _test_doubles();
+    _test_halfway();
+    _test_carry();
+    _test_special();
+    _test_truncation();
+    printf("%" PRIu64 " values checked\n", _checked);
+    _bench();
+    return LOG_TEST_RESULT();
+}
@@ -0,0 +1,154 @@
+/*
+    Test of logger instances against the global logger.
+
+    Instance line is built by the same code as line of log_it(), so the same message at the same time
+    gives the same text. Instance takes timestamps from its own io. Message longer than the buffer of
+    the instance is truncated with the notice, with LOG_BUILTIN_PRINTF it's written whole in parts.
+    Statistics count lines of instances by their level.
+*/
+
+#include <string.h>
+
+#include "log_.c"
+#include "log_test.h"
+
+#if (LOG_INSTANCES_ENABLED != 1U) || (LOG_STATS_ENABLED != 1U) || (LOG_TIMESTAMP_ENABLED != 1U)
+#    error Instance test must be built with LOG_INSTANCES_ENABLED, LOG_STATS_ENABLED and LOG_TIMESTAMP_ENABLED
+#endif
+
+#define _BUFF_SIZE (64U)
+
+typedef struct {
+    char text[1024];
+    size_t len;
+    uint32_t writes;
+} _output_t;
+
+static _output_t _global_out;
+static _output_t _instance_out;
+static uint32_t _global_ms;
+static uint32_t _instance_ms;
+
+/* -------------------------------------------------------------------------- */
+
+static void _put(_output_t *out, const uint8_t *data, size_t size) {
+    if ((out->len + size) < sizeof(out->text)) {
+        memcpy(&out->text[out->len], data, size);
+        out->len += size;
+        out->text[out->len] = '\0';
+    }
+    out->writes++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _global_write(const uint8_t *data, size_t size) {
+    _put(&_global_out, data, size);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _instance_write(const uint8_t *data, size_t size) {
+    _put(&_instance_out, data, size);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static log_timestamp_t _global_uptime_ms(void) {
+    return (log_timestamp_t)_global_ms;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static log_timestamp_t _instance_uptime_ms(void) {
+    return (log_timestamp_t)_instance_ms;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static const log_io_t _global_io = {
+    .write = _global_write,
+    .get_uptime_ms = _global_uptime_ms,
+};
+
+static const log_io_t _instance_io = {
+    .write = _instance_write,
+    .get_uptime_ms = _instance_uptime_ms,
+};
+
+/* -------------------------------------------------------------------------- */
+
+static void _reset(void) {
+    memset(&_global_out, 0, sizeof(_global_out));
+    memset(&_instance_out, 0, sizeof(_instance_out));
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    static char buff[_BUFF_SIZE];
+    static log_instance_t instance;
+    LOG_TEST_CHECK(log_init(LOG_MASK_ALL, &_global_io) == LOGGER_RESULT_OK, "log_init failed");
+    LOG_TEST_CHECK(log_instance_init(&instance, LOG_MASK_ALL & ~LOG_MASK_DEBUG, &_instance_io, buff, sizeof(buff)) ==
+                       LOGGER_RESULT_OK,
+                   "log_instance_init failed");
+
+    /* The same line from both loggers */
+    _global_ms = 1000U;
+    _instance_ms = 1000U;
+    log_it(LOG_MASK_INFO, "link %s speed %d Mbps %5.2f%%", "up", 100, 99.5);
+    log_instance_it(&instance, LOG_MASK_INFO, "link %s speed %d Mbps %5.2f%%", "up", 100, 99.5);
+    LOG_TEST_CHECK(strcmp(_global_out.text, "[0001.000] link up speed 100 Mbps 99.50%\n") == 0, "global '%s'", _global_out.text);
+    LOG_TEST_CHECK(strcmp(_instance_out.text, _global_out.text) == 0, "instance '%s'", _instance_out.text);
+    log_raw(LOG_MASK_INFO, "raw %u", 7U);
+    log_instance_raw(&instance, LOG_MASK_INFO, "raw %u", 7U);
+    LOG_TEST_CHECK(strcmp(_instance_out.text, _global_out.text) == 0, "raw '%s'", _instance_out.text);
+    _reset();
+
+    /* Clock of the instance */
+    _instance_ms = 2500U;
+    log_instance_it(&instance, LOG_MASK_ERROR, "own clock");
+    LOG_TEST_CHECK(strcmp(_instance_out.text, "[0002.500] own clock\n") == 0, "instance '%s'", _instance_out.text);
+    LOG_TEST_CHECK(_global_out.len == 0, "instance line in global io '%s'", _global_out.text);
+    _reset();
+
+    /* Message longer than the buffer */
+    log_stats_t stats;
+    (void)log_get_stats(&stats, true);
+    char message[3U * _BUFF_SIZE];
+    for (size_t i = 0; i < (sizeof(message) - 1U); i++) {
+        message[i] = (char)('a' + (i % 26U));
+    }
+    message[sizeof(message) - 1U] = '\0';
+    log_instance_it(&instance, LOG_MASK_WARNING, "%s", message);
+#if LOG_BUILTIN_PRINTF == 1U
+    char expected[sizeof(message) + 32U];
+    (void)snprintf(expected, sizeof(expected), "[0002.500] %s\n", message);
+    LOG_TEST_CHECK(strcmp(_instance_out.text, expected) == 0, "instance '%s'", _instance_out.text);
+    LOG_TEST_CHECK(_instance_out.writes > 1U, "long line is written by %" PRIu32 " parts", _instance_out.writes);
+    uint32_t truncated = 0;
+#else
+    char expected[sizeof(message) + sizeof(TRUNC_MESSAGE) + 32U];
+    (void)snprintf(expected,
+                   sizeof(expected),
+                   "[0002.500] %.*s\n%s",
+                   (int)(_BUFF_SIZE - sizeof("[0002.500] ")),
+                   message,
+                   (char const *)TRUNC_MESSAGE);
+    LOG_TEST_CHECK(strcmp(_instance_out.text, expected) == 0, "instance '%s'", _instance_out.text);
+    uint32_t truncated = 1U;
+#endif  // LOG_BUILTIN_PRINTF == 1U
+
+    /* Statistics */
+    log_instance_it(&instance, LOG_MASK_DEBUG, "filtered");
+    LOG_INSTANCE_DEBUG(&instance, "filtered by macro");
+    (void)log_get_stats(&stats, false);
+    log_level_stats_t const *warning = &stats.levels[_stats_level(LOG_MASK_WARNING)];
+    log_level_stats_t const *debug = &stats.levels[_stats_level(LOG_MASK_DEBUG)];
+    LOG_TEST_CHECK(warning->emitted == 1U, "%" PRIu32 " emitted", warning->emitted);
+    LOG_TEST_CHECK(warning->truncated == truncated, "%" PRIu32 " truncated", warning->truncated);
+    LOG_TEST_CHECK(warning->bytes == _instance_out.len, "%" PRIu32 " bytes of %zu", warning->bytes, _instance_out.len);
+    LOG_TEST_CHECK(debug->filtered == 2U, "%" PRIu32 " filtered", debug->filtered);
+
+    return LOG_TEST_RESULT();
+}
@@ -0,0 +1,154 @@
+/*
+    Test of LOG_ISR_QUEUE with interrupts simulated by SIGALRM.
+
+    Timer signal handler is the interrupt, io->is_isr() is true while it runs and it logs several numbered
+    lines per tick. Main loop logs its own numbered lines and calls log_flush_isr_queue() meanwhile. Every
+    line must arrive whole, lines of main and interrupt keep their order without repeats, interrupt lines
+    which are delivered and ones reported by "N messages were dropped" add up to logged ones, one flush
+    writes at most LOG_ISR_FLUSH_BUDGET interrupt lines.
+*/
+
+#include <signal.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "log_.c"
+#include "log_test.h"
+
+#if LOG_ISR_QUEUE != 1U
+#    error ISR test must be built with LOG_ISR_QUEUE
+#endif
+
+#define _MAIN_LINES    (200000U)
+#define _LINES_PER_IRQ (3U)
+
+static volatile sig_atomic_t _in_isr;
+static volatile uint32_t _isr_sent;
+
+/* Output is parsed by lines, write may get part of line */
+static char _text[256];
+static size_t _text_len;
+static uint32_t _isr_next;
+static uint32_t _main_next;
+static uint64_t _isr_delivered;
+static uint64_t _isr_dropped;
+static uint32_t _isr_in_flush;
+
+/* -------------------------------------------------------------------------- */
+
+static bool _ends_with(char const *line, char const *end) {
+    size_t len = strlen(line);
+    size_t end_len = strlen(end);
+    return (len >= end_len) && (strcmp(&line[len - end_len], end) == 0);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _parse(char const *line) {
+    unsigned value = 0;
+    char const *isr = strstr(line, "isr ");
+    char const *main_line = strstr(line, "main ");
+    if (sscanf(line, "%u messages were dropped", &value) == 1) {
+        _isr_dropped += value;
+    } else if ((isr != NULL) && (sscanf(isr, "isr %u", &value) == 1)) {
+        LOG_TEST_CHECK(_ends_with(line, " payload of interrupt line"), "torn line '%s'", line);
+        LOG_TEST_CHECK(value >= _isr_next, "interrupt line %u after %u", value, _isr_next);
+        _isr_next = value + 1U;
+        _isr_delivered++;
+        _isr_in_flush++;
+    } else if ((main_line != NULL) && (sscanf(main_line, "main %u", &value) == 1)) {
+        LOG_TEST_CHECK(_ends_with(line, " payload of main loop line"), "torn line '%s'", line);
+        LOG_TEST_CHECK(value == _main_next, "main line %u, expected %u", value, _main_next);
+        _main_next = value + 1U;
+    } else {
+        LOG_TEST_CHECK(false, "broken line '%s'", line);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _write(const uint8_t *data, size_t size) {
+    LOG_TEST_CHECK(_in_isr == 0, "io is written from interrupt");
+    for (size_t i = 0; i < size; i++) {
+        if (data[i] == '\n') {
+            _text[_text_len] = '\0';
+            _parse(_text);
+            _text_len = 0;
+        } else if (_text_len < (sizeof(_text) - 1U)) {
+            _text[_text_len++] = (char)data[i];
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static bool _is_isr(void) {
+    return _in_isr != 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static const log_io_t _io = {
+    .write = _write,
+    .is_isr = _is_isr,
+};
+
+/* -------------------------------------------------------------------------- */
+
+static void _on_alarm(int signal) {
+    (void)signal;
+    _in_isr = 1;
+    for (uint32_t i = 0; i < _LINES_PER_IRQ; i++) {
+        LOG_INFO("isr %" PRIu32 " payload of interrupt line", _isr_sent);
+        _isr_sent = _isr_sent + 1U;
+    }
+    _in_isr = 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _flush(void) {
+    _isr_in_flush = 0;
+    log_flush_isr_queue();
+    LOG_TEST_CHECK(_isr_in_flush <= LOG_ISR_FLUSH_BUDGET, "%" PRIu32 " lines written by one flush", _isr_in_flush);
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    LOG_TEST_CHECK(log_init(LOG_MASK_ALL, &_io) == LOGGER_RESULT_OK, "log_init failed");
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = _on_alarm;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGALRM, &action, NULL);
+    struct itimerval timer = { .it_interval = { .tv_sec = 0, .tv_usec = 20 }, .it_value = { .tv_sec = 0, .tv_usec = 20 } };
+    setitimer(ITIMER_REAL, &timer, NULL);
+
+    for (uint32_t i = 0; i < _MAIN_LINES; i++) {
+        LOG_INFO("main %" PRIu32 " payload of main loop line", i);
+        if ((i % 16U) == 0) {
+            _flush();
+        }
+    }
+
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_REAL, &timer, NULL);
+    uint64_t delivered = 0;
+    do {
+        delivered = _isr_delivered;
+        _flush();
+    } while (_isr_delivered != delivered);
+
+    printf("interrupt lines: sent %" PRIu32 " delivered %" PRIu64 " dropped %" PRIu64 ", main lines %" PRIu32 "\n",
+           _isr_sent,
+           _isr_delivered,
+           _isr_dropped,
+           _main_next);
+    LOG_TEST_CHECK(_isr_sent > 0, "no interrupts");
+    LOG_TEST_CHECK((_isr_delivered + _isr_dropped) == _isr_sent, "lost interrupt lines");
+    LOG_TEST_CHECK(_main_next == _MAIN_LINES, "lost main lines");
+    LOG_TEST_CHECK(_text_len == 0, "unfinished line");
+    return LOG_TEST_RESULT();
+}
@@ -0,0 +1,352 @@
+/*
+    Differential test of LOG_BUILTIN_PRINTF against vsnprintf of libc.
+
+    Formats are built from tables of flags, widths, precisions and length modifiers for every supported
+    conversion, each one is printed by log_raw() path and by vsnprintf with the same arguments and must
+    give the same text. Widths and precisions come as numbers and as '*' arguments, negative ones too.
+    Messages longer than LOG_MAX_MESSAGE_LENGTH are written by parts and compared as a whole.
+    Floating conversions get longer precisions and extreme values too, digits of %e, %g and long %f are exact.
+*/
+
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "log_.c"
+#include "log_test.h"
+
+#if LOG_BUILTIN_PRINTF != 1U
+#    error Printf test must be built with LOG_BUILTIN_PRINTF
+#endif
+
+#define _TEXT_SIZE (8U * LOG_MAX_MESSAGE_LENGTH)
+
+/* Width or precision taken from '*' argument, positive and negative ones */
+#define _STAR_WIDTHS     (2U)
+#define _STAR_PRECISIONS (2U)
+static const int _STAR_WIDTH[_STAR_WIDTHS] = { 9, -9 };
+static const int _STAR_PRECISION[_STAR_PRECISIONS] = { 3, -1 };
+
+static const char *const _WIDTHS[] = { "", "1", "6", "14", "*" };
+static const char *const _PRECISIONS[] = { "", ".", ".0", ".1", ".5", ".9", "*" };
+
+static char _out[_TEXT_SIZE];
+static size_t _out_len;
+static uint32_t _writes;
+static uint64_t _checked;
+
+/* -------------------------------------------------------------------------- */
+
+static void _write(const uint8_t *data, size_t size) {
+    if ((_out_len + size) < sizeof(_out)) {
+        memcpy(&_out[_out_len], data, size);
+        _out_len += size;
+    }
+    _writes++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static const log_io_t _io = {
+    .write = _write,
+};
+
+/* -------------------------------------------------------------------------- */
+
+/* Prints by both and compares, 'libc_format' differs from 'format' only for conversions printed as %f */
+static void _check_as(const char *libc_format, const char *format, ...) {
+    char expected[_TEXT_SIZE];
+    va_list args;
+    va_start(args, format);
+    int expected_len = vsnprintf(expected, sizeof(expected), libc_format, args);
+    va_end(args);
+
+    _out_len = 0;
+    va_start(args, format);
+    _log_format(LOG_MASK_INFO, format, args, false);
+    va_end(args);
+
+    LOG_TEST_CHECK((expected_len == (int)_out_len) && (memcmp(expected, _out, _out_len) == 0),
+                   "'%s': expected '%s' (%d), got '%.*s' (%zu)",
+                   format,
+                   expected,
+                   expected_len,
+                   (int)_out_len,
+                   _out,
+                   _out_len);
+    _checked++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Every combination of flags from 'flags' string, the first one is empty */
+static uint32_t _flag_sets(char const *flags, char sets[][8]) {
+    size_t count = strlen(flags);
+    for (uint32_t set = 0; set < (1UL << count); set++) {
+        size_t len = 0;
+        for (size_t i = 0; i < count; i++) {
+            if ((set & (1UL << i)) != 0) {
+                sets[set][len++] = flags[i];
+            }
+        }
+        sets[set][len] = '\0';
+    }
+    return 1UL << count;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/*
+    Calls CHECK(FORMAT, ...) with '*' arguments which FORMAT takes in front of the value,
+    every star value is tried
+*/
+#define _FOR_STARS(IS_WIDTH_STAR, IS_PRECISION_STAR, FORMAT, ...)                                         \
+    do {                                                                                                  \
+        for (uint32_t star_w = 0; star_w < ((IS_WIDTH_STAR) ? _STAR_WIDTHS : 1U); star_w++) {             \
+            for (uint32_t star_p = 0; star_p < ((IS_PRECISION_STAR) ? _STAR_PRECISIONS : 1U); star_p++) { \
+                if ((IS_WIDTH_STAR) && (IS_PRECISION_STAR)) {                                             \
+                    _check_as(FORMAT, FORMAT, _STAR_WIDTH[star_w], _STAR_PRECISION[star_p], __VA_ARGS__); \
+                } else if (IS_WIDTH_STAR) {                                                               \
+                    _check_as(FORMAT, FORMAT, _STAR_WIDTH[star_w], __VA_ARGS__);                          \
+                } else if (IS_PRECISION_STAR) {                                                           \
+                    _check_as(FORMAT, FORMAT, _STAR_PRECISION[star_p], __VA_ARGS__);                      \
+                } else {                                                                                  \
+                    _check_as(FORMAT, FORMAT, __VA_ARGS__);                                               \
+                }                                                                                         \
+            }                                                                                             \
+        }                                                                                                 \
+    } while (0)
+
+/* -------------------------------------------------------------------------- */
+
+/* Builds "%<flags><width><precision><length><conversion>", precision "*" becomes ".*" */
+static bool _format(char *dst, char const *flags, char const *width, char const *precision, char const *length,
+                    char conversion) {
+    bool is_precision_star = (strcmp(precision, "*") == 0);
+    (void)snprintf(dst, 32U, "%%%s%s%s%s%c", flags, width, is_precision_star ? ".*" : precision, length, conversion);
+    return is_precision_star;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _test_signed(void) {
+    static const long long values[] = { 0, 1, -1, 7, -42, 300, -129, 65537, INT_MAX, INT_MIN, LLONG_MAX, LLONG_MIN };
+    static const char *const lengths[] = { "", "hh", "h", "l", "ll", "j", "z", "t" };
+    char sets[32][8];
+    uint32_t flags_count = _flag_sets("-+ 0", sets);
+
+    for (char const *conversion = "di"; *conversion != '\0'; conversion++) {
+        for (uint32_t f = 0; f < flags_count; f++) {
+            for (size_t w = 0; w < (sizeof(_WIDTHS) / sizeof(_WIDTHS[0])); w++) {
+                bool is_width_star = (strcmp(_WIDTHS[w], "*") == 0);
+                for (size_t p = 0; p < (sizeof(_PRECISIONS) / sizeof(_PRECISIONS[0])); p++) {
+                    for (size_t l = 0; l < (sizeof(lengths) / sizeof(lengths[0])); l++) {
+                        char format[32];
+                        bool is_precision_star = _format(format, sets[f], _WIDTHS[w], _PRECISIONS[p], lengths[l], *conversion);
+                        for (size_t v = 0; v < (sizeof(values) / sizeof(values[0])); v++) {
+                            long long value = values[v];
+                            switch (l) {
+                                case 0:
+                                case 1:
+                                case 2:
+                                    _FOR_STARS(is_width_star, is_precision_star, format, (int)value);
+                                    break;
+                                case 3:
+                                    _FOR_STARS(is_width_star, is_precision_star, format, (long)value);
+                                    break;
+                                case 4:
+                                    _FOR_STARS(is_width_star, is_precision_star, format, value);
+                                    break;
+                                case 5:
+                                    _FOR_STARS(is_width_star, is_precision_star, format, (intmax_t)value);
+                                    break;
+                                case 6:
+                                    /* Signed type of size_t */
+                                    _FOR_STARS(is_width_star, is_precision_star, format, (ptrdiff_t)value);
+                                    break;
+                                default:
+                                    _FOR_STARS(is_width_star, is_precision_star, format, (ptrdiff_t)value);
+                                    break;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _test_unsigned(void) {
+    static const unsigned long long values[] = { 0, 1, 7, 8, 255, 256, 4095, 65535, 65536, UINT_MAX, ULLONG_MAX };
+    static const char *const lengths[] = { "", "hh", "h", "l", "ll", "j", "z" };
+    char sets[32][8];
+    uint32_t flags_count = _flag_sets("-#0", sets);
+
+    for (char const *conversion = "uxXo"; *conversion != '\0'; conversion++) {
+        for (uint32_t f = 0; f < flags_count; f++) {
+            if ((*conversion == 'u') && (strchr(sets[f], '#') != NULL)) {
+                continue; /* '#' isn't defined for %u */
+            }
+            for (size_t w = 0; w < (sizeof(_WIDTHS) / sizeof(_WIDTHS[0])); w++) {
+                bool is_width_star = (strcmp(_WIDTHS[w], "*") == 0);
+                for (size_t p = 0; p < (sizeof(_PRECISIONS) / sizeof(_PRECISIONS[0])); p++) {
+                    for (size_t l = 0; l < (sizeof(lengths) / sizeof(lengths[0])); l++) {
+                        char format[32];
+                        bool is_precision_star = _format(format, sets[f], _WIDTHS[w], _PRECISIONS[p], lengths[l], *conversion);
+                        for (size_t v = 0; v < (sizeof(values) / sizeof(values[0])); v++) {
+                            unsigned long long value = values[v];
+                            switch (l) {
+                                case 0:
+                                case 1:
+                                case 2:
+                                    _FOR_STARS(is_width_star, is_precision_star, format, (unsigned)value);
+                                    break;
+                                case 3:
+                                    _FOR_STARS(is_width_star, is_precision_star, format, (unsigned long)value);
+                                    break;
+                                case 4:
+                                    _FOR_STARS(is_width_star, is_precision_star, format, value);
+                                    break;
+                                case 5:
+                                    _FOR_STARS(is_width_star, is_precision_star, format, (uintmax_t)value);
+                                    break;
+                                default:
+                                    _FOR_STARS(is_width_star, is_precision_star, format, (size_t)value);
+                                    break;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _test_double(void) {
+    static const double values[] = {
+        0.0, -0.0, 0.5, 1.5, 2.5, -2.25, 3.14159265358979, 0.05, 0.999999, 9.9999999996, 123456.789,
+        1e-5, -1e-12, 1e10, 4294967296.5, 1e19, DBL_MAX, FLT_MIN, DBL_MIN, 5e-324, 1e-300, 0.0001,
+        0.00009999, 9.9999e9, 123456789.0, 1e100, 0.1, INFINITY, -INFINITY, NAN,
+    };
+    static const char *const precisions[] = { ".12", ".17", ".30" };
+    char sets[32][8];
+    uint32_t flags_count = _flag_sets("-+ #0", sets);
+
+    for (char const *conversion = "fFeEgGaA"; *conversion != '\0'; conversion++) {
+        /* Long double of x86 has other hexadecimal digits in %La */
+        bool is_long = (*conversion != 'a') && (*conversion != 'A');
+        for (uint32_t f = 0; f < flags_count; f++) {
+            for (size_t w = 0; w < (sizeof(_WIDTHS) / sizeof(_WIDTHS[0])); w++) {
+                bool is_width_star = (strcmp(_WIDTHS[w], "*") == 0);
+                for (size_t p = 0; p < (sizeof(_PRECISIONS) / sizeof(_PRECISIONS[0])); p++) {
+                    char format[32];
+                    bool is_precision_star = _format(format, sets[f], _WIDTHS[w], _PRECISIONS[p], "", *conversion);
+                    char long_format[32];
+                    (void)_format(long_format, sets[f], _WIDTHS[w], _PRECISIONS[p], "L", *conversion);
+                    for (size_t v = 0; v < (sizeof(values) / sizeof(values[0])); v++) {
+                        _FOR_STARS(is_width_star, is_precision_star, format, values[v]);
+                        if (is_long == true) {
+                            _FOR_STARS(is_width_star, is_precision_star, long_format, (long double)values[v]);
+                        }
+                    }
+                }
+            }
+            for (size_t p = 0; p < (sizeof(precisions) / sizeof(precisions[0])); p++) {
+                char format[32];
+                (void)_format(format, sets[f], "", precisions[p], "", *conversion);
+                for (size_t v = 0; v < (sizeof(values) / sizeof(values[0])); v++) {
+                    _check_as(format, format, values[v]);
+                }
+            }
+        }
+    }
+
+    /* Digits of subnormals and of the largest value, rounding ties of binary fractions */
+    _check_as("%.760e", "%.760e", 5e-324);
+    _check_as("%.400e", "%.400e", DBL_MIN);
+    _check_as("%.0f %.1f %.2f %.0e", "%.0f %.1f %.2f %.0e", 0.5, 0.25, 1.125, 2.5);
+    _check_as("%.320g", "%.320g", DBL_MAX);
+    _check_as("%.3a %.0a %.1a", "%.3a %.0a %.1a", 1.99999, 1.5, 1.96875);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _test_text(void) {
+    static const char *const strings[] = { "", "a", "hello", "string of twenty one", NULL };
+    static const char *const widths[] = { "", "3", "8", "25", "*" };
+    static const char *const precisions[] = { "", ".", ".0", ".3", ".6", ".30", "*" };
+    static const char chars[] = { 'a', ' ', '~' };
+    int variable = 0;
+    void *const pointers[] = { NULL, &variable, (void *)(uintptr_t)0x1234U };
+
+    static const char *const flags[] = { "", "-" };
+    for (size_t f = 0; f < (sizeof(flags) / sizeof(flags[0])); f++) {
+        char const *flag = flags[f];
+        for (size_t w = 0; w < (sizeof(widths) / sizeof(widths[0])); w++) {
+            bool is_width_star = (strcmp(widths[w], "*") == 0);
+            char format[32];
+            for (size_t p = 0; p < (sizeof(precisions) / sizeof(precisions[0])); p++) {
+                bool is_precision_star = _format(format, flag, widths[w], precisions[p], "", 's');
+                for (size_t s = 0; s < (sizeof(strings) / sizeof(strings[0])); s++) {
+                    _FOR_STARS(is_width_star, is_precision_star, format, strings[s]);
+                }
+            }
+            (void)_format(format, flag, widths[w], "", "", 'c');
+            for (size_t c = 0; c < sizeof(chars); c++) {
+                _FOR_STARS(is_width_star, false, format, chars[c]);
+            }
+            (void)_format(format, flag, widths[w], "", "", 'p');
+            for (size_t i = 0; i < (sizeof(pointers) / sizeof(pointers[0])); i++) {
+                _FOR_STARS(is_width_star, false, format, pointers[i]);
+            }
+        }
+    }
+
+    _check_as("100%% of %d%%", "100%% of %d%%", 5);
+    _check_as("no conversions", "no conversions", 0);
+    _check_as("%s=%d, %s=%u, %c%c", "%s=%d, %s=%u, %c%c", "first", -1, "second", 2U, 'o', 'k');
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Text crosses parts of LOG_MAX_MESSAGE_LENGTH inside of conversions and between them */
+static void _test_long(void) {
+    char text[3U * LOG_MAX_MESSAGE_LENGTH];
+    for (size_t i = 0; i < (sizeof(text) - 1U); i++) {
+        text[i] = (char)('A' + (i % 26U));
+    }
+    text[sizeof(text) - 1U] = '\0';
+
+    _writes = 0;
+    _check_as("%s", "%s", text);
+    LOG_TEST_CHECK(_writes > 1U, "long message is written by %" PRIu32 " parts", _writes);
+    _check_as("[%s] %d [%s]", "[%s] %d [%s]", text, 12345, text);
+    _check_as("%*d|", "%*d|", (int)(2U * LOG_MAX_MESSAGE_LENGTH), -7);
+    _check_as("%-*s|", "%-*s|", (int)(2U * LOG_MAX_MESSAGE_LENGTH), "left");
+    _check_as("%0*.3f|", "%0*.3f|", (int)(LOG_MAX_MESSAGE_LENGTH + 5U), -2.5);
+    _check_as("%.*s", "%.*s", (int)(LOG_MAX_MESSAGE_LENGTH + 1U), text);
+    for (size_t offset = LOG_MAX_MESSAGE_LENGTH - 8U; offset < (LOG_MAX_MESSAGE_LENGTH + 8U); offset++) {
+        _check_as("%.*s%llx %+.4f %s", "%.*s%llx %+.4f %s", (int)offset, text, 0xFEDCBA9876543210ULL, 1.0 / 3.0, "end");
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    LOG_TEST_CHECK(log_init(LOG_MASK_ALL, &_io) == LOGGER_RESULT_OK, "log_init failed");
+
+    _test_signed();
+    _test_unsigned();
+    _test_double();
+    _test_text();
+    _test_long();
+
+    printf("%" PRIu64 " formats checked\n", _checked);
+    return LOG_TEST_RESULT();
+}
@@ -0,0 +1,194 @@
+/*
+    Test of flight recorder surviving the crash of the process.
+
+    Child process maps a file over pages of the recorder buffer, as RAM which is not cleared on reset,
+    logs numbered lines and is killed at random point. Recorder is rebuilt from the image of the file,
+    as after reset, and log_recorder_dump() must write the last lines whole and in order.
+    Then the image is damaged:
+        - payload byte of a record is changed, only that line is skipped and dump returns error
+        - buffer of other format or garbage is taken as not initialized RAM and cleared
+*/
+
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* Recorder takes whole pages, so file can be mapped over them */
+#define LOG_RECORDER_ATTRIBUTE __attribute__((section(".noinit"), aligned(65536)))
+
+#include "log_.c"
+#include "log_test.h"
+
+#if LOG_RECORDER_ENABLED != 1U
+#    error Recorder test must be built with LOG_RECORDER_ENABLED
+#endif
+
+#define _IMAGE_PATH "log_test_recorder.img"
+
+static char _out[2U * LOG_RECORDER_SIZE];
+static size_t _out_len;
+
+/* -------------------------------------------------------------------------- */
+
+static void _write(const uint8_t *data, size_t size) {
+    if ((_out_len + size) < sizeof(_out)) {
+        memcpy(&_out[_out_len], data, size);
+        _out_len += size;
+        _out[_out_len] = '\0';
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static const log_io_t _io = {
+    .write = _write,
+};
+
+/* -------------------------------------------------------------------------- */
+
+static size_t _pages_size(void) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return (sizeof(_recorder) + page - 1U) & ~(page - 1U);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Recorder is placed in the file, so what it keeps stays there when process is killed */
+static void _child(int ready) {
+    int fd = open(_IMAGE_PATH, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    size_t size = _pages_size();
+    if ((fd < 0) || (write(fd, &_recorder, size) != (ssize_t)size) ||
+        (mmap(&_recorder, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)) {
+        _exit(EXIT_FAILURE);
+    }
+
+    (void)log_init(LOG_MASK_ALL, &_io);
+    for (uint32_t i = 0;; i++) {
+        log_it(LOG_MASK_INFO, "record %" PRIu32 " of the run before reset", i);
+        if (i == 1000U) {
+            (void)write(ready, "1", 1);
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _load(uint8_t const *image) {
+    memcpy(&_recorder, image, sizeof(_recorder));
+    _out_len = 0;
+    _out[0] = '\0';
+    LOG_TEST_CHECK(log_init(LOG_MASK_ALL, &_io) == LOGGER_RESULT_OK, "log_init failed");
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Returns number of lines between begin and end of the dump, they must be consecutive except 'missing' */
+static uint32_t _check_dump(uint32_t missing, uint32_t *first) {
+    char *line = strstr(_out, "Flight recorder begin\n");
+    LOG_TEST_CHECK(line != NULL, "no begin in '%s'", _out);
+    if (line == NULL) {
+        return 0;
+    }
+    line += sizeof("Flight recorder begin\n") - 1U;
+
+    uint32_t count = 0;
+    uint32_t next = 0;
+    while (strncmp(line, "record ", 7U) == 0) {
+        unsigned value = 0;
+        int end = 0;
+        LOG_TEST_CHECK((sscanf(line, "record %u of the run before reset\n%n", &value, &end) == 1) && (end > 0),
+                       "torn line '%.40s'",
+                       line);
+        if (end == 0) {
+            break;
+        }
+        if (count == 0) {
+            *first = value;
+        } else {
+            if (next == missing) {
+                next++;
+            }
+            LOG_TEST_CHECK(value == next, "line %u, expected %u", value, next);
+        }
+        next = value + 1U;
+        count++;
+        line += end;
+    }
+    return count;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    int ready[2];
+    LOG_TEST_CHECK(pipe(ready) == 0, "pipe failed");
+    pid_t child = fork();
+    if (child == 0) {
+        close(ready[0]);
+        _child(ready[1]);
+    }
+    close(ready[1]);
+    char byte = 0;
+    LOG_TEST_CHECK(read(ready[0], &byte, 1) == 1, "child failed");
+    usleep(1000U + (unsigned)(getpid() % 10000));
+    kill(child, SIGKILL);
+    waitpid(child, NULL, 0);
+
+    int fd = open(_IMAGE_PATH, O_RDONLY);
+    uint8_t *image = mmap(NULL, _pages_size(), PROT_READ, MAP_PRIVATE, fd, 0);
+    LOG_TEST_CHECK((fd >= 0) && (image != MAP_FAILED), "no image");
+    if ((fd < 0) || (image == MAP_FAILED)) {
+        return LOG_TEST_RESULT();
+    }
+    static uint8_t copy[sizeof(log_recorder_t)];
+    memcpy(copy, image, sizeof(copy));
+    munmap(image, _pages_size());
+    close(fd);
+    unlink(_IMAGE_PATH);
+
+    /* Lines before the kill */
+    _load(copy);
+    LOG_TEST_CHECK(log_recorder_dump() == LOGGER_RESULT_OK, "dump failed");
+    uint32_t first = 0;
+    uint32_t count = _check_dump(UINT32_MAX, &first);
+    printf("recorder kept %" PRIu32 " lines from %" PRIu32 "\n", count, first);
+    LOG_TEST_CHECK(count > 10U, "only %" PRIu32 " lines", count);
+    LOG_TEST_CHECK(strstr(_out, "Flight recorder end\n") != NULL, "no end");
+
+    /* Damaged text of the third record */
+    log_recorder_t *recorder = (log_recorder_t *)copy;
+    uint32_t position = recorder->tail;
+    memcpy(&_recorder, copy, sizeof(_recorder));
+    for (uint32_t i = 0; i < 2U; i++) {
+        position += _recorder_record_size(position);
+    }
+    recorder->data[(position + _RECORDER_OVERHEAD + 3U) & (LOG_RECORDER_SIZE - 1U)] ^= 0x20U;
+    _load(copy);
+    LOG_TEST_CHECK(log_recorder_dump() == LOGGER_RESULT_ERROR, "damaged record isn't reported");
+    uint32_t damaged_first = 0;
+    LOG_TEST_CHECK(_check_dump(first + 2U, &damaged_first) == (count - 1U), "more than one line is skipped");
+    LOG_TEST_CHECK(damaged_first == first, "dump starts from %" PRIu32, damaged_first);
+    LOG_TEST_CHECK(strstr(_out, "Flight recorder skipped 1 records with bad checksum\n") != NULL, "no report in '%s'", _out);
+
+    /* Buffer of another layout */
+    recorder->magic = 0x4C4F4752UL;
+    _load(copy);
+    LOG_TEST_CHECK(log_recorder_dump() == LOGGER_RESULT_OK, "cleared buffer isn't valid");
+    LOG_TEST_CHECK(strcmp(_out, "Flight recorder begin\nFlight recorder end\n") == 0,
+                   "buffer of another layout is dumped '%s'", _out);
+
+    /* Garbage */
+    uint32_t state = 12345U;
+    for (size_t i = 0; i < sizeof(copy); i++) {
+        state = (state * 1103515245U) + 12345U;
+        copy[i] = (uint8_t)(state >> 16);
+    }
+    _load(copy);
+    LOG_TEST_CHECK(log_recorder_dump() == LOGGER_RESULT_OK, "cleared buffer isn't valid");
+    LOG_TEST_CHECK(strcmp(_out, "Flight recorder begin\nFlight recorder end\n") == 0, "garbage is dumped '%s'", _out);
+
+    return LOG_TEST_RESULT();
+}
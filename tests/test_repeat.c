@@ -0,0 +1,63 @@
+/*
+    Test of LOG_COLLAPSE_REPEATS.
+
+    Identical consecutive lines are written once and counted, lines which differ only by level are not
+    collapsed, different messages with the same FNV-1a hash are not collapsed too.
+*/
+
+#include <string.h>
+
+#include "log_.c"
+#include "log_test.h"
+
+#if LOG_COLLAPSE_REPEATS != 1U
+#    error Repeat test must be built with LOG_COLLAPSE_REPEATS
+#endif
+
+static char _out[1024];
+static size_t _out_len;
+
+/* -------------------------------------------------------------------------- */
+
+static void _write(const uint8_t *data, size_t size) {
+    if ((_out_len + size) < sizeof(_out)) {
+        memcpy(&_out[_out_len], data, size);
+        _out_len += size;
+        _out[_out_len] = '\0';
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static const log_io_t _io = {
+    .write = _write,
+};
+
+/* -------------------------------------------------------------------------- */
+
+static void _expect(const char *expected) {
+    LOG_TEST_CHECK(strcmp(_out, expected) == 0, "expected:\n%s\ngot:\n%s", expected, _out);
+    _out_len = 0;
+    _out[0] = '\0';
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    LOG_TEST_CHECK(log_init(LOG_MASK_ALL, &_io) == LOGGER_RESULT_OK, "log_init failed");
+
+    for (uint32_t i = 0; i < 4U; i++) {
+        log_it(LOG_MASK_INFO, "value %d", 1);
+    }
+    log_it(LOG_MASK_ERROR, "value %d", 1);
+    _expect("value 1\nLast message repeated 3 times\nvalue 1\n");
+
+    /* Both messages have FNV-1a hash 0x2F415942 */
+    log_it(LOG_MASK_INFO, "value %d", 579599);
+    log_it(LOG_MASK_INFO, "value %d", 762382);
+    log_it(LOG_MASK_INFO, "value %d", 762382);
+    log_it(LOG_MASK_INFO, "done");
+    _expect("value 579599\nvalue 762382\nLast message repeated 1 times\ndone\n");
+
+    return LOG_TEST_RESULT();
+}
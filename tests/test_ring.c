@@ -0,0 +1,149 @@
+/*
+    Stress test of lock-free ring of asynchronous mode.
+
+    Several producer threads push numbered records of different length while consumer thread drains the ring
+    by log_process() to the write callback. Each record must arrive whole and once, records of a producer must
+    keep their order. Policy is selected by LOG_ASYNC_POLICY of the test variant:
+        - Drop policy: producer retries the push until record fits, so every record is delivered.
+        - Overwrite policy: records may be evicted, delivered and dropped ones reported by
+          "N messages were dropped" must add up to pushed records.
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "log_.c"
+#include "log_test.h"
+
+#if LOG_ASYNC_ENABLED != 1U
+#    error Ring test must be built with LOG_ASYNC_ENABLED
+#endif
+
+#define _PRODUCERS    (4U)
+#define _RECORDS      (200000U)
+#define _IS_OVERWRITE (LOG_ASYNC_POLICY == LOG_ASYNC_OVERWRITE)
+
+static atomic_bool _is_running;
+
+/* Consumer side, written only by the thread which drains the ring */
+static uint32_t _next[_PRODUCERS];
+static uint64_t _delivered;
+static uint64_t _dropped;
+
+/* -------------------------------------------------------------------------- */
+
+static size_t _record(char *buff, uint32_t producer, uint32_t seq) {
+    int len = sprintf(buff, "p%" PRIu32 " s%" PRIu32 " ", producer, seq);
+    uint32_t fill = ((seq * 7U) + producer) % 41U;
+    for (uint32_t i = 0; i < fill; i++) {
+        buff[len++] = (char)('a' + ((seq + i) % 26U));
+    }
+    buff[len++] = '\n';
+    return (size_t)len;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _write(const uint8_t *data, size_t size) {
+    char text[128];
+    LOG_TEST_CHECK(size < sizeof(text), "record of %zu bytes", size);
+    if (size >= sizeof(text)) {
+        return;
+    }
+    memcpy(text, data, size);
+    text[size] = '\0';
+
+    unsigned dropped = 0;
+    if (sscanf(text, "%u messages were dropped", &dropped) == 1) {
+        _dropped += dropped;
+        return;
+    }
+
+    unsigned producer = 0;
+    unsigned seq = 0;
+    LOG_TEST_CHECK(sscanf(text, "p%u s%u ", &producer, &seq) == 2, "broken record '%s'", text);
+    LOG_TEST_CHECK(producer < _PRODUCERS, "unknown producer %u", producer);
+    if (producer >= _PRODUCERS) {
+        return;
+    }
+
+    char expected[128];
+    size_t expected_size = _record(expected, producer, seq);
+    LOG_TEST_CHECK((expected_size == size) && (memcmp(expected, text, size) == 0), "torn record '%s'", text);
+#if _IS_OVERWRITE
+    /* Evicted records leave gaps, the rest keeps order without repeats */
+    LOG_TEST_CHECK(seq >= _next[producer], "producer %u record %u after %u", producer, seq, _next[producer]);
+#else
+    LOG_TEST_CHECK(seq == _next[producer], "producer %u record %u, expected %u", producer, seq, _next[producer]);
+#endif  // _IS_OVERWRITE
+    _next[producer] = seq + 1U;
+    _delivered++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void *_producer(void *arg) {
+    uint32_t producer = (uint32_t)(uintptr_t)arg;
+    char buff[128];
+    for (uint32_t seq = 0; seq < _RECORDS; seq++) {
+        size_t size = _record(buff, producer, seq);
+        while ((_ring_push(&_ctx.ring, LOG_MASK_INFO, (uint8_t const *)buff, size) == false) && (_IS_OVERWRITE == 0)) {
+            sched_yield();
+        }
+        if ((seq % 64U) == 0) {
+            sched_yield(); /* Lets consumer in between on single core */
+        }
+    }
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void *_consumer(void *arg) {
+    (void)arg;
+    while (atomic_load_explicit(&_is_running, memory_order_acquire) == true) {
+        if (log_process() == 0) {
+            sched_yield();
+        }
+    }
+    (void)log_process();
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    static const log_io_t io = { .write = _write };
+    LOG_TEST_CHECK(log_init(LOG_MASK_ALL, &io) == LOGGER_RESULT_OK, "log_init");
+
+    pthread_t consumer;
+    pthread_t producers[_PRODUCERS];
+    atomic_store(&_is_running, true);
+    pthread_create(&consumer, NULL, _consumer, NULL);
+    for (uint32_t i = 0; i < _PRODUCERS; i++) {
+        pthread_create(&producers[i], NULL, _producer, (void *)(uintptr_t)i);
+    }
+    for (uint32_t i = 0; i < _PRODUCERS; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    atomic_store(&_is_running, false);
+    pthread_join(consumer, NULL);
+
+    uint64_t pushed = (uint64_t)_PRODUCERS * _RECORDS;
+    printf("%s: delivered %" PRIu64 " dropped %" PRIu64 " of %" PRIu64 "\n",
+           (_IS_OVERWRITE) ? "overwrite" : "drop",
+           _delivered,
+           _dropped,
+           pushed);
+#if _IS_OVERWRITE
+    LOG_TEST_CHECK((_delivered + _dropped) == pushed, "lost records");
+#else
+    LOG_TEST_CHECK(_delivered == pushed, "lost records");
+    for (uint32_t i = 0; i < _PRODUCERS; i++) {
+        LOG_TEST_CHECK(_next[i] == _RECORDS, "producer %" PRIu32 " stopped at %" PRIu32, i, _next[i]);
+    }
+#endif  // _IS_OVERWRITE
+    return LOG_TEST_RESULT();
+}
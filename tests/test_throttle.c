@@ -0,0 +1,158 @@
+/*
+    Test of LOG_EVERY_MS with clock of the test.
+
+    Site lets one message per period through and reports skipped ones at its level before the next one,
+    site which stays silent after a burst is reported by LOG call of another site and by log_flush_isr_queue(),
+    disabled level doesn't touch the site.
+    LOG_EVERY_N and LOG_ONCE shared by threads let exact number of statements through, N of 0 lets all of them.
+*/
+
+#include <pthread.h>
+#include <string.h>
+
+#include "log_.c"
+#include "log_test.h"
+
+#define _THREADS    (4U)
+#define _SITE_CALLS (1000000U)
+#define _EVERY_N    (100U)
+
+static uint32_t _now_ms;
+static atomic_uint _every_n_hits;
+static atomic_uint _every_0_hits;
+static atomic_uint _once_hits;
+static pthread_barrier_t _start;
+static char _out[4096];
+static size_t _out_len;
+
+/* -------------------------------------------------------------------------- */
+
+static void _write(const uint8_t *data, size_t size) {
+    if ((_out_len + size) < sizeof(_out)) {
+        memcpy(&_out[_out_len], data, size);
+        _out_len += size;
+        _out[_out_len] = '\0';
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static log_timestamp_t _get_uptime_ms(void) {
+    return (log_timestamp_t)_now_ms;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static bool _is_isr(void) {
+    return false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static const log_io_t _io = {
+    .write = _write,
+    .get_uptime_ms = _get_uptime_ms,
+    .is_isr = _is_isr,
+};
+
+/* -------------------------------------------------------------------------- */
+
+static void _expect(const char *expected) {
+    LOG_TEST_CHECK(strcmp(_out, expected) == 0, "expected:\n%s\ngot:\n%s", expected, _out);
+    _out_len = 0;
+    _out[0] = '\0';
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _burst(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        LOG_EVERY_MS(100U, LOG_MASK_WARNING, log_it(LOG_MASK_WARNING, "burst %" PRIu32, i));
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void _debug(void) {
+    LOG_EVERY_MS(100U, LOG_MASK_DEBUG, log_it(LOG_MASK_DEBUG, "debug"));
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void *_site_caller(void *arg) {
+    (void)arg;
+    (void)pthread_barrier_wait(&_start);
+    for (uint32_t i = 0; i < _SITE_CALLS; i++) {
+        LOG_EVERY_N(_EVERY_N, atomic_fetch_add(&_every_n_hits, 1U));
+        LOG_EVERY_N(0U, atomic_fetch_add(&_every_0_hits, 1U));
+        LOG_ONCE(atomic_fetch_add(&_once_hits, 1U));
+    }
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    _now_ms = 1000U;
+    LOG_TEST_CHECK(log_init(LOG_MASK_ALL & ~LOG_MASK_DEBUG, &_io) == LOGGER_RESULT_OK, "log_init failed");
+
+    /* The first message goes through, the rest of the period is counted */
+    _burst(5U);
+    _expect("[0001.000] burst 0\n");
+
+    /* Next message of the site reports them first */
+    _now_ms += 100U;
+    _burst(1U);
+    _expect("[0001.100] 4 similar messages were skipped\n[0001.100] burst 0\n");
+
+    /* Burst and silence, report waits for the end of the period */
+    _burst(3U);
+    _expect("");
+    log_it(LOG_MASK_INFO, "other");
+    _expect("[0001.100] other\n");
+    _now_ms += 150U;
+    log_it(LOG_MASK_INFO, "other");
+    _expect("[0001.250] 3 similar messages were skipped\n[0001.250] other\n");
+
+    /* Report takes the period, flush of interrupt queue writes it too */
+    _now_ms += 50U;
+    _burst(2U);
+    _expect("");
+    _now_ms += 100U;
+    log_flush_isr_queue();
+    _expect("[0001.400] 2 similar messages were skipped\n");
+    _now_ms += 100U;
+    log_flush_isr_queue();
+    _expect("");
+
+    _burst(2U);
+    _expect("[0001.500] burst 0\n");
+    _now_ms += 100U;
+    log_flush_isr_queue();
+    _expect("[0001.600] 1 similar messages were skipped\n");
+
+    /* Disabled level is skipped before the site is registered */
+    uint32_t count = atomic_load(&_ctx.throttles_count);
+    _debug();
+    _debug();
+    LOG_TEST_CHECK(atomic_load(&_ctx.throttles_count) == count, "site of disabled level is registered");
+    LOG_TEST_CHECK(atomic_load(&_ctx.is_throttled) == false, "disabled level is counted");
+    _expect("");
+
+    /* Sites shared by threads */
+    pthread_t threads[_THREADS];
+    (void)pthread_barrier_init(&_start, NULL, _THREADS);
+    for (uint32_t i = 0; i < _THREADS; i++) {
+        (void)pthread_create(&threads[i], NULL, _site_caller, NULL);
+    }
+    for (uint32_t i = 0; i < _THREADS; i++) {
+        (void)pthread_join(threads[i], NULL);
+    }
+    LOG_TEST_CHECK(atomic_load(&_every_n_hits) == ((_THREADS * _SITE_CALLS) / _EVERY_N), "LOG_EVERY_N let %u through",
+                   atomic_load(&_every_n_hits));
+    LOG_TEST_CHECK(atomic_load(&_every_0_hits) == (_THREADS * _SITE_CALLS), "LOG_EVERY_N of 0 let %u through",
+                   atomic_load(&_every_0_hits));
+    LOG_TEST_CHECK(atomic_load(&_once_hits) == 1U, "LOG_ONCE let %u through", atomic_load(&_once_hits));
+
+    return LOG_TEST_RESULT();
+}
@@ -0,0 +1,15 @@
+#ifndef __LOG_CONF_H__
+#define __LOG_CONF_H__
+
+/*
+    Configuration of log_bench, options under test are passed by compiler
+    definitions of each log_bench_<variant> target, others keep defaults of log_.h
+*/
+
+#define LOG_ENABLED (1U)
+
+#if !defined(LOG_ENDLINE)
+#    define LOG_ENDLINE "\r\n"
+#endif  // LOG_ENDLINE
+
+#endif /*__LOG_CONF_H__*/
@@ -0,0 +1,369 @@
+/*
+    Measures cost of log_it, log_raw, log_array and log_array_float per call.
+
+    Each configuration of log_conf.h is separate executable log_bench_<variant>, build all of them and
+    run them one by one by LOG_BUILD_BENCH cmake option:
+        cmake -S . -B build -DLOG_BUILD_BENCH=ON -DCMAKE_BUILD_TYPE=Release
+        cmake --build build --target log_bench
+
+    Usage: log_bench_<variant> [messages per case] [max threads]
+    Output is one JSON object per line:
+        {"variant":"ts2","case":"log_it","sink":"null","threads":1,"messages":200000,"ns_per_msg":95.1,"bytes_per_s":...}
+    LOG_COMPRESS_ENABLED variant adds "ratio" of raw line bytes to compressed bytes of io->write
+    LOG_IO_WRITE_ASYNC variants send buffers by transmitter thread which simulates DMA of UART, txblock waits for it
+    LOG_TIMERS_ENABLED variant adds "scope_timer" case, cost of LOG_SCOPE_TIMER with clock reads
+*/
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "log_.h"
+
+#if LOG_ENABLED != 1U
+#    error Benchmark must be built with LOG_ENABLED
+#endif
+
+#if !defined(LOG_BENCH_VARIANT)
+#    define LOG_BENCH_VARIANT "custom"
+#endif  // LOG_BENCH_VARIANT
+
+/* ===== IO ================================================================= */
+
+static atomic_uint_fast64_t _bytes;
+static bool _is_counting;
+
+static void _write(const uint8_t *data, size_t size) {
+    (void)data;
+    if (_is_counting == true) {
+        atomic_fetch_add_explicit(&_bytes, size, memory_order_relaxed);
+    }
+}
+
+#if (LOG_COMPRESS_ENABLED == 1U) && (LOG_SINKS_ENABLED == 1U)
+/* Same lines before compression, they are counted by sink of the same colors and timestamps */
+static atomic_uint_fast64_t _raw_bytes;
+
+static void _write_raw(const uint8_t *data, size_t size) {
+    (void)data;
+    if (_is_counting == true) {
+        atomic_fetch_add_explicit(&_raw_bytes, size, memory_order_relaxed);
+    }
+}
+
+static const log_sink_t _raw_sink = {
+    .write = _write_raw,
+    .mask = LOG_MASK_ALL,
+    .timestamp = LOG_SINK_TIMESTAMP_FULL,
+    .is_color = true,
+};
+#endif  // (LOG_COMPRESS_ENABLED == 1U) && (LOG_SINKS_ENABLED == 1U)
+
+#if LOG_IO_WRITEV == 1U
+static void _writev(const log_iovec_t *iov, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        _write(iov[i].data, iov[i].size);
+    }
+}
+#endif  // LOG_IO_WRITEV == 1U
+
+#if LOG_IO_WRITE_ASYNC == 1U
+static const uint8_t *_tx_data;
+static size_t _tx_size;
+static sem_t _tx_start;
+static sem_t _tx_done;
+
+static void _write_async(const uint8_t *data, size_t size) {
+    _tx_data = data;
+    _tx_size = size;
+    sem_post(&_tx_start);
+}
+
+/* Transmitter thread is the DMA of UART, it calls log_write_complete() as TX complete interrupt */
+static void *_transmitter(void *arg) {
+    (void)arg;
+    for (;;) {
+        sem_wait(&_tx_start);
+        _write(_tx_data, _tx_size);
+        log_write_complete();
+        sem_post(&_tx_done);
+    }
+    return NULL;
+}
+
+#    if LOG_IO_BUFFER_POLICY == LOG_ASYNC_BLOCK
+static void _wait(void) {
+    sem_wait(&_tx_done);
+}
+#    endif  // LOG_IO_BUFFER_POLICY == LOG_ASYNC_BLOCK
+#endif  // LOG_IO_WRITE_ASYNC == 1U
+
+#if LOG_THREADSAFE_ENABLED == 1U
+static pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void _lock(void) {
+    pthread_mutex_lock(&_mutex);
+}
+
+static void _unlock(void) {
+    pthread_mutex_unlock(&_mutex);
+}
+#endif  // LOG_THREADSAFE_ENABLED == 1U
+
+static uint64_t _now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+#if LOG_TIMESTAMP_ENABLED == 1U
+static log_timestamp_t _get_uptime_ms(void) {
+    return (log_timestamp_t)(_now_ns() / 1000000ULL);
+}
+#endif  // LOG_TIMESTAMP_ENABLED == 1U
+
+#if LOG_TIMESTAMP_TICKS == 1U
+static log_timestamp_t _get_ticks(void) {
+    return (log_timestamp_t)(_now_ns() / (1000000000ULL / LOG_TIMESTAMP_TICK_HZ));
+}
+#endif  // LOG_TIMESTAMP_TICKS == 1U
+
+#if LOG_TIMESTAMP_FORMAT > 0U
+static time_t _get_utc_time_s(void) {
+    return time(NULL);
+}
+#endif  // LOG_TIMESTAMP_FORMAT > 0U
+
+#if LOG_ISR_QUEUE == 1U
+/* Every call of the case is made from simulated interrupt and queue is flushed after it */
+static _Thread_local bool _in_isr;
+
+static bool _is_isr(void) {
+    return _in_isr;
+}
+#endif  // LOG_ISR_QUEUE == 1U
+
+static const log_io_t _io = {
+    .write = _write,
+#if LOG_THREADSAFE_ENABLED == 1U
+    .lock = _lock,
+    .unlock = _unlock,
+#endif  // LOG_THREADSAFE_ENABLED == 1U
+#if LOG_TIMESTAMP_ENABLED == 1U
+    .get_uptime_ms = _get_uptime_ms,
+#endif  // LOG_TIMESTAMP_ENABLED == 1U
+#if LOG_TIMESTAMP_TICKS == 1U
+    .get_ticks = _get_ticks,
+#endif  // LOG_TIMESTAMP_TICKS == 1U
+#if LOG_TIMESTAMP_FORMAT > 0U
+    .get_utc_time_s = _get_utc_time_s,
+#endif  // LOG_TIMESTAMP_FORMAT > 0U
+#if LOG_ISR_QUEUE == 1U
+    .is_isr = _is_isr,
+#endif  // LOG_ISR_QUEUE == 1U
+#if LOG_IO_WRITEV == 1U
+    .writev = _writev,
+#endif  // LOG_IO_WRITEV == 1U
+#if LOG_IO_WRITE_ASYNC == 1U
+    .write_async = _write_async,
+#    if LOG_IO_BUFFER_POLICY == LOG_ASYNC_BLOCK
+    .wait = _wait,
+#    endif  // LOG_IO_BUFFER_POLICY == LOG_ASYNC_BLOCK
+#endif  // LOG_IO_WRITE_ASYNC == 1U
+};
+
+/* ===== CASES ============================================================== */
+
+static uint8_t _array[64];
+static float _floats[16];
+
+static void _case_log_it(uint32_t i) {
+    LOG_INFO("Sensor %" PRIu32 " value %d state %s", i, (int)(i * 7U), "ok");
+}
+
+static void _case_log_raw(uint32_t i) {
+    LOG_RAW("raw %" PRIu32 LOG_ENDLINE, i);
+}
+
+static void _case_log_array(uint32_t i) {
+    (void)i;
+    LOG_DEBUG_ARRAY("Packet", _array, sizeof(_array));
+}
+
+static void _case_log_array_float(uint32_t i) {
+    (void)i;
+    LOG_DEBUG_ARRAY_F("Samples", _floats, sizeof(_floats) / sizeof(_floats[0]));
+}
+
+#if LOG_TIMERS_ENABLED == 1U
+/* Recording only, nothing is written */
+static void _case_scope_timer(uint32_t i) {
+    LOG_SCOPE_TIMER(bench);
+    (void)i;
+}
+#endif  // LOG_TIMERS_ENABLED == 1U
+
+typedef struct {
+    const char *name;
+    void (*run)(uint32_t i);
+} bench_case_t;
+
+static const bench_case_t _cases[] = {
+    { "log_it", _case_log_it },
+    { "log_raw", _case_log_raw },
+    { "log_array", _case_log_array },
+    { "log_array_float", _case_log_array_float },
+#if LOG_TIMERS_ENABLED == 1U
+    { "scope_timer", _case_scope_timer },
+#endif  // LOG_TIMERS_ENABLED == 1U
+};
+
+/* ===== RUNNER ============================================================= */
+
+typedef struct {
+    bench_case_t const *bench;
+    uint32_t messages;
+} bench_job_t;
+
+#if LOG_ASYNC_ENABLED == 1U
+static atomic_bool _is_running;
+#endif  // LOG_ASYNC_ENABLED == 1U
+
+static void _drain(void) {
+#if LOG_ASYNC_ENABLED == 1U
+    while (log_process() > 0) {
+    }
+#endif  // LOG_ASYNC_ENABLED == 1U
+}
+
+static void *_producer(void *arg) {
+    bench_job_t const *job = (bench_job_t const *)arg;
+    for (uint32_t i = 0; i < job->messages; i++) {
+#if LOG_ISR_QUEUE == 1U
+        _in_isr = true;
+        job->bench->run(i);
+        _in_isr = false;
+        log_flush_isr_queue();
+#else
+        job->bench->run(i);
+#endif  // LOG_ISR_QUEUE == 1U
+#if LOG_ASYNC_ENABLED == 1U
+        if (atomic_load_explicit(&_is_running, memory_order_relaxed) == false) {
+            _drain(); /* Single thread run, there is no consumer thread */
+        }
+#endif  // LOG_ASYNC_ENABLED == 1U
+    }
+    return NULL;
+}
+
+#if LOG_ASYNC_ENABLED == 1U
+static void *_consumer(void *arg) {
+    (void)arg;
+    while (atomic_load_explicit(&_is_running, memory_order_acquire) == true) {
+        _drain();
+    }
+    _drain();
+    return NULL;
+}
+#endif  // LOG_ASYNC_ENABLED == 1U
+
+static void _run(bench_case_t const *bench, bool is_counting, uint32_t threads, uint32_t messages) {
+    _is_counting = is_counting;
+    atomic_store(&_bytes, 0);
+#if (LOG_COMPRESS_ENABLED == 1U) && (LOG_SINKS_ENABLED == 1U)
+    atomic_store(&_raw_bytes, 0);
+#endif  // (LOG_COMPRESS_ENABLED == 1U) && (LOG_SINKS_ENABLED == 1U)
+    bench_job_t job = { .bench = bench, .messages = messages };
+    pthread_t producers[threads];
+
+    uint64_t start = _now_ns();
+    if (threads == 1U) {
+        (void)_producer(&job);
+        _drain();
+    } else {
+#if LOG_ASYNC_ENABLED == 1U
+        pthread_t consumer;
+        atomic_store(&_is_running, true);
+        pthread_create(&consumer, NULL, _consumer, NULL);
+#endif  // LOG_ASYNC_ENABLED == 1U
+        for (uint32_t i = 0; i < threads; i++) {
+            pthread_create(&producers[i], NULL, _producer, &job);
+        }
+        for (uint32_t i = 0; i < threads; i++) {
+            pthread_join(producers[i], NULL);
+        }
+#if LOG_ASYNC_ENABLED == 1U
+        atomic_store(&_is_running, false);
+        pthread_join(consumer, NULL);
+#endif  // LOG_ASYNC_ENABLED == 1U
+    }
+    uint64_t elapsed = _now_ns() - start;
+
+    uint64_t total = (uint64_t)messages * threads;
+    double seconds = (double)elapsed / 1e9;
+    printf("{\"variant\":\"%s\",\"case\":\"%s\",\"sink\":\"%s\",\"threads\":%" PRIu32 ",\"messages\":%" PRIu64
+           ",\"ns_per_msg\":%.1f,\"bytes_per_s\":%.0f",
+           LOG_BENCH_VARIANT,
+           bench->name,
+           (is_counting == true) ? "count" : "null",
+           threads,
+           total,
+           (double)elapsed / (double)total,
+           (is_counting == true) ? ((double)atomic_load(&_bytes) / seconds) : 0.0);
+#if (LOG_COMPRESS_ENABLED == 1U) && (LOG_SINKS_ENABLED == 1U)
+    if (is_counting == true) {
+        printf(",\"ratio\":%.2f", (double)atomic_load(&_raw_bytes) / (double)atomic_load(&_bytes));
+    }
+#endif  // (LOG_COMPRESS_ENABLED == 1U) && (LOG_SINKS_ENABLED == 1U)
+    printf("}\n");
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    uint32_t messages = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 200000U;
+    uint32_t max_threads = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 4U;
+
+    for (size_t i = 0; i < sizeof(_array); i++) {
+        _array[i] = (uint8_t)(i * 37U);
+    }
+    for (size_t i = 0; i < sizeof(_floats) / sizeof(_floats[0]); i++) {
+        _floats[i] = ((float)i * 1.37f) - 10.0f;
+    }
+
+#if LOG_IO_WRITE_ASYNC == 1U
+    pthread_t transmitter;
+    sem_init(&_tx_start, 0, 0);
+    sem_init(&_tx_done, 0, 0);
+    pthread_create(&transmitter, NULL, _transmitter, NULL);
+    pthread_detach(transmitter);
+#endif  // LOG_IO_WRITE_ASYNC == 1U
+
+    if (log_init(LOG_MASK_ALL, &_io) != LOGGER_RESULT_OK) {
+        fprintf(stderr, "log_init failed\n");
+        return EXIT_FAILURE;
+    }
+#if (LOG_COMPRESS_ENABLED == 1U) && (LOG_SINKS_ENABLED == 1U)
+    (void)log_add_sink(&_raw_sink);
+#endif  // (LOG_COMPRESS_ENABLED == 1U) && (LOG_SINKS_ENABLED == 1U)
+
+    for (size_t i = 0; i < sizeof(_cases) / sizeof(_cases[0]); i++) {
+        _run(&_cases[i], false, 1U, messages);
+        _run(&_cases[i], true, 1U, messages);
+    }
+
+    /* Contention is measured only where LOG calls from several threads are allowed */
+#if (LOG_THREADSAFE_ENABLED == 1U) || (LOG_ASYNC_ENABLED == 1U)
+    for (uint32_t threads = 2U; threads <= max_threads; threads *= 2U) {
+        _run(&_cases[0], true, threads, messages / threads);
+    }
+#else
+    (void)max_threads;
+#endif  // (LOG_THREADSAFE_ENABLED == 1U) || (LOG_ASYNC_ENABLED == 1U)
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,115 @@
+/*
+    Measures cost of LOG_INFO and LOG_RAW of C++ front-end log_.hpp, compare it with log_it
+    and log_raw cases of log_bench_default, both use the same log_conf.h.
+
+    Built and run together with log_bench by LOG_BUILD_BENCH cmake option:
+        cmake -S . -B build -DLOG_BUILD_BENCH=ON -DCMAKE_BUILD_TYPE=Release
+        cmake --build build --target log_bench
+
+    Usage: log_bench_hpp [messages per case]
+    Output is one JSON object per line:
+        {"variant":"hpp","case":"log_it","sink":"null","threads":1,"messages":200000,"ns_per_msg":95.1,"bytes_per_s":...}
+*/
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#include "log_.hpp"
+
+#if LOG_ENABLED != 1U
+#    error Benchmark must be built with LOG_ENABLED
+#endif
+
+/* ===== IO ================================================================= */
+
+static uint64_t _bytes;
+static bool _is_counting;
+
+static void _write(const uint8_t *data, size_t size) {
+    (void)data;
+    if (_is_counting == true) {
+        _bytes += size;
+    }
+}
+
+static uint64_t _now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+#if LOG_TIMESTAMP_ENABLED == 1U
+static log_timestamp_t _get_uptime_ms(void) {
+    return (log_timestamp_t)(_now_ns() / 1000000ULL);
+}
+#endif  // LOG_TIMESTAMP_ENABLED == 1U
+
+static log_io_t _make_io(void) {
+    log_io_t io = {};
+    io.write = _write;
+#if LOG_TIMESTAMP_ENABLED == 1U
+    io.get_uptime_ms = _get_uptime_ms;
+#endif  // LOG_TIMESTAMP_ENABLED == 1U
+    return io;
+}
+
+/* ===== CASES ============================================================== */
+
+static void _case_log_it(uint32_t i) {
+    LOG_INFO("Sensor %" PRIu32 " value %d state %s", i, (int)(i * 7U), "ok");
+}
+
+static void _case_log_raw(uint32_t i) {
+    LOG_RAW("raw %" PRIu32 LOG_ENDLINE, i);
+}
+
+struct bench_case_t {
+    const char *name;
+    void (*run)(uint32_t i);
+};
+
+static const bench_case_t _cases[] = {
+    { "log_it", _case_log_it },
+    { "log_raw", _case_log_raw },
+};
+
+/* ===== RUNNER ============================================================= */
+
+static void _run(bench_case_t const *bench, bool is_counting, uint32_t messages) {
+    _is_counting = is_counting;
+    _bytes = 0;
+
+    uint64_t start = _now_ns();
+    for (uint32_t i = 0; i < messages; i++) {
+        bench->run(i);
+    }
+    uint64_t elapsed = _now_ns() - start;
+
+    double seconds = (double)elapsed / 1e9;
+    printf("{\"variant\":\"hpp\",\"case\":\"%s\",\"sink\":\"%s\",\"threads\":1,\"messages\":%" PRIu32
+           ",\"ns_per_msg\":%.1f,\"bytes_per_s\":%.0f}\n",
+           bench->name,
+           (is_counting == true) ? "count" : "null",
+           messages,
+           (double)elapsed / (double)messages,
+           (is_counting == true) ? ((double)_bytes / seconds) : 0.0);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    uint32_t messages = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 200000U;
+
+    static const log_io_t io = _make_io();
+    if (log_init(LOG_MASK_ALL, &io) != LOGGER_RESULT_OK) {
+        fprintf(stderr, "log_init failed\n");
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < sizeof(_cases) / sizeof(_cases[0]); i++) {
+        _run(&_cases[i], false, messages);
+        _run(&_cases[i], true, messages);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+/*
+    Host side decoder of LOG_DEFERRED_FORMAT stream.
+
+    Build it with the same log_conf.h as firmware, e.g. by LOG_BUILD_DECODER cmake option or:
+        cc -DLOG_DEFERRED_DECODER=1 -I<log_ dir> -I<log_conf.h dir> log_decode.c log_.c -o log_decode
+
+    Extract format strings from firmware and decode captured stream:
+        objcopy -O binary --only-section=log_fmt firmware.elf log_fmt.bin
+        log_decode log_fmt.bin < capture.bin
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log_.h"
+
+#if (LOG_ENABLED != 1U) || (LOG_DEFERRED_DECODER != 1U)
+#    error Decoder must be built with LOG_ENABLED and LOG_DEFERRED_DECODER
+#endif
+
+/* -------------------------------------------------------------------------- */
+
+static void _write(const uint8_t *data, size_t size) {
+    (void)fwrite(data, 1, size, stdout);
+}
+
+#if LOG_THREADSAFE_ENABLED == 1U
+static void _lock(void) {
+}
+
+static void _unlock(void) {
+}
+#endif  // LOG_THREADSAFE_ENABLED == 1U
+
+/* Timestamps are taken from frames, these are only to pass log_init() */
+#if LOG_TIMESTAMP_ENABLED == 1U
+static log_timestamp_t _get_uptime_ms(void) {
+    return 0;
+}
+#endif  // LOG_TIMESTAMP_ENABLED == 1U
+
+#if LOG_TIMESTAMP_FORMAT > 0U
+static time_t _get_utc_time_s(void) {
+    return 0;
+}
+#endif  // LOG_TIMESTAMP_FORMAT > 0U
+
+#if LOG_ISR_QUEUE == 1U
+static bool _is_isr(void) {
+    return false;
+}
+#endif  // LOG_ISR_QUEUE == 1U
+
+static const log_io_t _io = {
+    .write = _write,
+#if LOG_THREADSAFE_ENABLED == 1U
+    .lock = _lock,
+    .unlock = _unlock,
+#endif  // LOG_THREADSAFE_ENABLED == 1U
+#if LOG_TIMESTAMP_ENABLED == 1U
+    .get_uptime_ms = _get_uptime_ms,
+#endif  // LOG_TIMESTAMP_ENABLED == 1U
+#if LOG_TIMESTAMP_FORMAT > 0U
+    .get_utc_time_s = _get_utc_time_s,
+#endif  // LOG_TIMESTAMP_FORMAT > 0U
+#if LOG_ISR_QUEUE == 1U
+    .is_isr = _is_isr,
+#endif  // LOG_ISR_QUEUE == 1U
+};
+
+/* -------------------------------------------------------------------------- */
+
+static char *_read_file(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+
+    char *data = NULL;
+    size_t capacity = 0;
+    *size = 0;
+    for (;;) {
+        if (*size == capacity) {
+            capacity = (capacity == 0) ? 4096U : (capacity * 2U);
+            char *grown = realloc(data, capacity);
+            if (grown == NULL) {
+                free(data);
+                (void)fclose(file);
+                return NULL;
+            }
+            data = grown;
+        }
+        size_t len = fread(&data[*size], 1, capacity - *size, file);
+        if (len == 0) {
+            break;
+        }
+        *size += len;
+    }
+    (void)fclose(file);
+
+    return data;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        (void)fprintf(stderr, "Usage: %s <log_fmt section binary> < stream\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    size_t formats_size = 0;
+    char *formats = _read_file(argv[1], &formats_size);
+    if (formats == NULL) {
+        (void)fprintf(stderr, "Can't read %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    if (log_init(LOG_MASK_ALL, &_io) != LOGGER_RESULT_OK) {
+        free(formats);
+        return EXIT_FAILURE;
+    }
+
+    uint8_t stream[4096];
+    size_t len = 0;
+    for (;;) {
+        size_t read = fread(&stream[len], 1, sizeof(stream) - len, stdin);
+        if (read == 0) {
+            break;
+        }
+        len += read;
+
+        size_t used = log_deferred_decode(formats, formats_size, stream, len);
+        len -= used;
+        memmove(stream, &stream[used], len);
+    }
+
+    free(formats);
+    return EXIT_SUCCESS;
+}
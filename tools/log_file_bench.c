@@ -0,0 +1,210 @@
+/*
+    Compares log_file backend with write() call per line.
+
+    Built and run together with log_bench by LOG_BUILD_BENCH cmake option:
+        cmake -S . -B build -DLOG_BUILD_BENCH=ON -DCMAKE_BUILD_TYPE=Release
+        cmake --build build --target log_bench
+
+    Usage: log_file_bench [messages per case] [max threads] [file]
+    Output is one JSON object per line, time includes closing of the file:
+        {"variant":"file","case":"log_it","sink":"log_file","threads":1,"messages":200000,"ns_per_msg":95.1,"bytes_per_s":...}
+*/
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "log_.h"
+#include "log_file.h"
+
+#if (LOG_ENABLED != 1U) || (LOG_THREADSAFE_ENABLED != 1U) || (LOG_IO_FLUSH != 1U)
+#    error File benchmark must be built with LOG_ENABLED, LOG_THREADSAFE_ENABLED and LOG_IO_FLUSH
+#endif
+
+/* ===== IO ================================================================= */
+
+static int _fd = -1;
+
+/* Baseline, every line is written by its own call */
+static void _write(const uint8_t *data, size_t size) {
+    while (size > 0) {
+        ssize_t len = write(_fd, data, size);
+        if (len <= 0) {
+            return;
+        }
+        data += len;
+        size -= (size_t)len;
+    }
+}
+
+static void _flush(void) {
+}
+
+#if LOG_IO_WRITEV == 1U
+static void _writev(const log_iovec_t *iov, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        _write(iov[i].data, iov[i].size);
+    }
+}
+#endif  // LOG_IO_WRITEV == 1U
+
+static pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void _lock(void) {
+    pthread_mutex_lock(&_mutex);
+}
+
+static void _unlock(void) {
+    pthread_mutex_unlock(&_mutex);
+}
+
+static uint64_t _now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+#if LOG_TIMESTAMP_ENABLED == 1U
+static log_timestamp_t _get_uptime_ms(void) {
+    return (log_timestamp_t)(_now_ns() / 1000000ULL);
+}
+#endif  // LOG_TIMESTAMP_ENABLED == 1U
+
+#if LOG_TIMESTAMP_FORMAT > 0U
+static time_t _get_utc_time_s(void) {
+    return time(NULL);
+}
+#endif  // LOG_TIMESTAMP_FORMAT > 0U
+
+#if LOG_ISR_QUEUE == 1U
+static bool _is_isr(void) {
+    return false;
+}
+#endif  // LOG_ISR_QUEUE == 1U
+
+static const log_io_t _io_write = {
+    .write = _write,
+    .lock = _lock,
+    .unlock = _unlock,
+#if LOG_TIMESTAMP_ENABLED == 1U
+    .get_uptime_ms = _get_uptime_ms,
+#endif  // LOG_TIMESTAMP_ENABLED == 1U
+#if LOG_TIMESTAMP_FORMAT > 0U
+    .get_utc_time_s = _get_utc_time_s,
+#endif  // LOG_TIMESTAMP_FORMAT > 0U
+#if LOG_ISR_QUEUE == 1U
+    .is_isr = _is_isr,
+#endif  // LOG_ISR_QUEUE == 1U
+#if LOG_IO_WRITEV == 1U
+    .writev = _writev,
+#endif  // LOG_IO_WRITEV == 1U
+    .flush = _flush,
+};
+
+static const log_io_t _io_file = {
+    .write = log_file_write,
+    .lock = _lock,
+    .unlock = _unlock,
+#if LOG_TIMESTAMP_ENABLED == 1U
+    .get_uptime_ms = _get_uptime_ms,
+#endif  // LOG_TIMESTAMP_ENABLED == 1U
+#if LOG_TIMESTAMP_FORMAT > 0U
+    .get_utc_time_s = _get_utc_time_s,
+#endif  // LOG_TIMESTAMP_FORMAT > 0U
+#if LOG_ISR_QUEUE == 1U
+    .is_isr = _is_isr,
+#endif  // LOG_ISR_QUEUE == 1U
+#if LOG_IO_WRITEV == 1U
+    .writev = log_file_writev,
+#endif  // LOG_IO_WRITEV == 1U
+    .flush = log_file_flush,
+};
+
+/* ===== RUNNER ============================================================= */
+
+typedef enum {
+    _SINK_WRITE,
+    _SINK_FILE,
+    _SINK_FILE_FSYNC,
+} bench_sink_t;
+
+static const char *const _SINK_NAMES[] = { "write", "log_file", "log_file_fsync" };
+
+static void *_producer(void *arg) {
+    uint32_t messages = *(uint32_t const *)arg;
+    for (uint32_t i = 0; i < messages; i++) {
+        LOG_INFO("Sensor %" PRIu32 " value %d state %s", i, (int)(i * 7U), "ok");
+    }
+    return NULL;
+}
+
+static bool _run(bench_sink_t sink, char const *path, uint32_t threads, uint32_t messages) {
+    (void)unlink(path);
+    log_io_t const *io = &_io_write;
+    if (sink == _SINK_WRITE) {
+        _fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (_fd < 0) {
+            return false;
+        }
+    } else {
+        log_file_config_t config = { .path = path, .flush_ms = 100U, .is_fsync = (sink == _SINK_FILE_FSYNC) };
+        if (log_file_open(&config) != LOGGER_RESULT_OK) {
+            return false;
+        }
+        io = &_io_file;
+    }
+    if (log_init(LOG_MASK_ALL, io) != LOGGER_RESULT_OK) {
+        return false;
+    }
+
+    pthread_t producers[threads];
+    uint64_t start = _now_ns();
+    for (uint32_t i = 0; i < threads; i++) {
+        pthread_create(&producers[i], NULL, _producer, &messages);
+    }
+    for (uint32_t i = 0; i < threads; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    if (sink == _SINK_WRITE) {
+        (void)close(_fd);
+    } else {
+        log_file_close();
+    }
+    uint64_t elapsed = _now_ns() - start;
+
+    struct stat info;
+    double bytes = (stat(path, &info) == 0) ? (double)info.st_size : 0.0;
+    uint64_t total = (uint64_t)messages * threads;
+    printf("{\"variant\":\"file\",\"case\":\"log_it\",\"sink\":\"%s\",\"threads\":%" PRIu32 ",\"messages\":%" PRIu64
+           ",\"ns_per_msg\":%.1f,\"bytes_per_s\":%.0f}\n",
+           _SINK_NAMES[sink],
+           threads,
+           total,
+           (double)elapsed / (double)total,
+           bytes / ((double)elapsed / 1e9));
+    fflush(stdout);
+    (void)unlink(path);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    uint32_t messages = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 200000U;
+    uint32_t max_threads = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 4U;
+    char const *path = (argc > 3) ? argv[3] : "log_file_bench.log";
+
+    for (bench_sink_t sink = _SINK_WRITE; sink <= _SINK_FILE_FSYNC; sink++) {
+        for (uint32_t threads = 1U; threads <= max_threads; threads *= 2U) {
+            if (_run(sink, path, threads, messages / threads) == false) {
+                fprintf(stderr, "Can't log to %s\n", path);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,94 @@
+/*
+    Host side decompressor of LOG_COMPRESS_ENABLED stream.
+
+    Build it with the same log_conf.h as firmware, window and dictionary must match,
+    e.g. by LOG_BUILD_UNCOMPRESS cmake option or:
+        cc -DLOG_COMPRESS_DECODER=1 -I<log_ dir> -I<log_conf.h dir> log_uncompress.c log_.c -o log_uncompress
+
+    Usage:
+        log_uncompress < capture.bin > capture.txt
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log_.h"
+
+#if (LOG_ENABLED != 1U) || (LOG_COMPRESS_DECODER != 1U)
+#    error Decompressor must be built with LOG_ENABLED and LOG_COMPRESS_DECODER
+#endif
+
+/* -------------------------------------------------------------------------- */
+
+static void _write(const uint8_t *data, size_t size) {
+    (void)fwrite(data, 1, size, stdout);
+}
+
+#if LOG_THREADSAFE_ENABLED == 1U
+static void _lock(void) {
+}
+
+static void _unlock(void) {
+}
+#endif  // LOG_THREADSAFE_ENABLED == 1U
+
+/* Stream already has timestamps, these are only to pass log_init() */
+#if LOG_TIMESTAMP_ENABLED == 1U
+static log_timestamp_t _get_uptime_ms(void) {
+    return 0;
+}
+#endif  // LOG_TIMESTAMP_ENABLED == 1U
+
+#if LOG_TIMESTAMP_FORMAT > 0U
+static time_t _get_utc_time_s(void) {
+    return 0;
+}
+#endif  // LOG_TIMESTAMP_FORMAT > 0U
+
+#if LOG_ISR_QUEUE == 1U
+static bool _is_isr(void) {
+    return false;
+}
+#endif  // LOG_ISR_QUEUE == 1U
+
+static const log_io_t _io = {
+    .write = _write,
+#if LOG_THREADSAFE_ENABLED == 1U
+    .lock = _lock,
+    .unlock = _unlock,
+#endif  // LOG_THREADSAFE_ENABLED == 1U
+#if LOG_TIMESTAMP_ENABLED == 1U
+    .get_uptime_ms = _get_uptime_ms,
+#endif  // LOG_TIMESTAMP_ENABLED == 1U
+#if LOG_TIMESTAMP_FORMAT > 0U
+    .get_utc_time_s = _get_utc_time_s,
+#endif  // LOG_TIMESTAMP_FORMAT > 0U
+#if LOG_ISR_QUEUE == 1U
+    .is_isr = _is_isr,
+#endif  // LOG_ISR_QUEUE == 1U
+};
+
+/* -------------------------------------------------------------------------- */
+
+int main(void) {
+    if (log_init(LOG_MASK_ALL, &_io) != LOGGER_RESULT_OK) {
+        return EXIT_FAILURE;
+    }
+
+    uint8_t stream[4096];
+    size_t len = 0;
+    for (;;) {
+        size_t read = fread(&stream[len], 1, sizeof(stream) - len, stdin);
+        if (read == 0) {
+            break;
+        }
+        len += read;
+
+        size_t used = log_uncompress(stream, len);
+        len -= used;
+        memmove(stream, &stream[used], len);
+    }
+
+    return EXIT_SUCCESS;
+}